@@ -1,41 +1,102 @@
 #include "gamecontroller.h"
+#include "tracing.h"
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
 
 GameController::GameController(QObject *parent)
     : QObject(parent)
     , m_game(nullptr)
     , m_difficulty(1)
+    , m_playerHearts(STARTING_HEARTS)
+    , m_playerPoints(0)
+    , m_speculationHits(0)
+    , m_speculationMisses(0)
+    , m_loading(false)
+    , m_aiEngine(AIEngine::Heuristic)
+    , m_aiThinking(false)
+    , m_nextJobId(1)
+    , m_activeJobId(0)
+    , m_activeJobKind(EngineJobKind::Solves)
 {
     m_game = new ShiritoriGame();
     m_gameStatus = "Ready to load database";
     m_topSolvesHistory.clear();
     m_playerWordHistory.clear();
+
+    connect(&m_loadWatcher, &QFutureWatcher<ShiritoriGame*>::finished,
+            this, &GameController::onDatabaseLoadFinished);
+    connect(&m_jobWatcher, &QFutureWatcher<EngineJobResult>::finished,
+            this, &GameController::onEngineJobFinished);
 }
 
 GameController::~GameController()
 {
+    finishPendingJob(true, true);
+    if (m_loading) {
+        m_loadWatcher.waitForFinished();
+        delete m_loadWatcher.result();
+    }
     delete m_game;
 }
 
-bool GameController::loadDatabase(const QString& dictPath, const QString& patternsPath)
+void GameController::loadDatabaseAsync(const QString& dictPath, const QString& patternsPath)
 {
-    if (!m_game) return false;
-    
-    qDebug() << "Loading database from:" << dictPath << "and" << patternsPath;
-    
-    bool success = m_game->load_database(dictPath.toStdString(), patternsPath.toStdString());
-    
-    if (success) {
+    TRACE_SPAN("GameController::loadDatabaseAsync");
+    if (m_loading) return;
+
+    qDebug() << "Loading database asynchronously from:" << dictPath << "and" << patternsPath;
+
+    m_loading = true;
+    emit loadingChanged();
+    m_gameStatus = "Loading database...";
+    emit gameStatusChanged();
+
+    // The load builds a fresh game on a worker thread, so the current one stays
+    // untouched (and the GUI responsive) until the new one is swapped in
+    const std::string dictFile = dictPath.toStdString();
+    const std::string patternsFile = patternsPath.toStdString();
+    m_loadWatcher.setFuture(QtConcurrent::run([this, dictFile, patternsFile]() -> ShiritoriGame* {
+        ShiritoriGame* game = new ShiritoriGame();
+        bool success = game->load_database(dictFile, patternsFile, [this](const LoadProgress& progress) {
+            const QString phase = QString::fromStdString(progress.phase);
+            const int count = static_cast<int>(progress.count);
+            const int elapsedMs = static_cast<int>(progress.elapsed_ms);
+            QMetaObject::invokeMethod(this, [this, phase, count, elapsedMs]() {
+                emit loadProgress(phase, count, elapsedMs);
+            }, Qt::QueuedConnection);
+        });
+        if (!success) {
+            delete game;
+            return nullptr;
+        }
+        return game;
+    }));
+}
+
+void GameController::onDatabaseLoadFinished()
+{
+    ShiritoriGame* loaded = m_loadWatcher.result();
+    m_loading = false;
+    emit loadingChanged();
+
+    if (loaded) {
+        finishPendingJob(true, true);
+        delete m_game;
+        m_game = loaded;
+        m_game->setAIEngine(m_aiEngine);
+        m_game->setSearchConfig(m_searchConfig);
+        m_game->setMonteCarloConfig(m_monteCarloConfig);
+        syncPlayerStats();
+        syncSpeculationStats();
         m_gameStatus = "Database loaded successfully! Ready to start.";
-        emit gameStatusChanged();
         qDebug() << "Database loaded successfully";
     } else {
         m_gameStatus = "Failed to load database. Check file paths.";
-        emit gameStatusChanged();
         qDebug() << "Failed to load database";
     }
-    
-    return success;
+    emit gameStatusChanged();
+    emit databaseLoaded(loaded != nullptr);
 }
 
 void GameController::startNewGame()
@@ -44,6 +105,7 @@ void GameController::startNewGame()
     
     qDebug() << "Starting new game";
     
+    finishPendingJob(true, true);
     m_game->reset_game();
     m_playerWords.clear();
     m_aiWords.clear();
@@ -53,8 +115,7 @@ void GameController::startNewGame()
     m_topSolvesHistory.clear();
     m_playerWordHistory.clear();
     
-    emit playerHeartsChanged();
-    emit playerPointsChanged();
+    syncPlayerStats();
     emit playerWordsChanged();
     emit aiWordsChanged();
     emit currentPrefixChanged();
@@ -77,8 +138,16 @@ void GameController::startNewGame()
 
 bool GameController::submitWord(const QString& word)
 {
+    TRACE_SPAN("GameController::submitWord");
     if (!m_game) return false;
     
+    // The AI has not answered the previous word yet
+    if (m_aiThinking) return false;
+
+    // Let any in-flight top-solve ranking land so the history below is complete;
+    // a running speculation is cut short, keeping the replies it already has
+    finishPendingJob(false);
+
     std::string wordStr = word.toLower().toStdString();
     
     qDebug() << "Submitting word:" << word;
@@ -115,6 +184,8 @@ bool GameController::submitWord(const QString& word)
     
     // Word is valid, process it
     m_game->processPlayerWord(wordStr);
+    // Before topSolveAchieved, whose handler checks playerPoints
+    syncPlayerStats();
     m_playerWords.append(word.toLower());
     m_playerWordHistory.push_back(wordStr);
     emit playerWordsChanged();
@@ -131,9 +202,6 @@ bool GameController::submitWord(const QString& word)
         emit topSolveAchieved();
     }
     
-    emit playerHeartsChanged();
-    emit playerPointsChanged();
-    
     // Display top solves after successful submission
     emit topSolvesChanged();
     
@@ -145,72 +213,236 @@ bool GameController::submitWord(const QString& word)
 
 void GameController::processAITurn()
 {
+    TRACE_SPAN("GameController::processAITurn");
     if (!m_game) return;
     
     qDebug() << "Processing AI turn";
     
-    std::string aiWord = m_game->getAIMove();
-    
-    if (aiWord.empty()) {
-        qDebug() << "AI has no valid move - player wins";
-        emit gameOver(true); // Player wins
-        return;
-    }
-    
-    m_aiWords.append(QString::fromStdString(aiWord));
-    emit aiWordsChanged();
-    
-    qDebug() << "AI played:" << QString::fromStdString(aiWord);
-    
-    // Update prefix for next player turn
-    std::string newPrefix = m_game->getCurrentPrefix();
-    
-    if (newPrefix.empty()) {
-        qDebug() << "No valid prefix - AI wins";
-        emit gameOver(false); // AI wins
+    // The reply may already have been worked out while the player was thinking
+    const SpeculativeReply* reply = m_game->playSpeculatedAIMove();
+    syncSpeculationStats();
+    if (reply) {
+        qDebug() << "Using speculated AI reply to:" << QString::fromStdString(reply->player_word);
+
+        EngineJobResult result;
+        result.kind = EngineJobKind::AITurn;
+        result.aiWord = reply->ai_word;
+        result.prefix = m_game->getCurrentPrefix();
+        result.difficulty = m_game->getCurrentDifficulty();
+        result.hasSolves = !result.aiWord.empty() && !result.prefix.empty();
+        result.topMoves = reply->top_moves;
+        result.regularMoves = reply->regular_moves;
+        applyEngineJobResult(result);
+        startSpeculation(result);
         return;
     }
-    
-    m_currentPrefix = QString::fromStdString(newPrefix);
-    emit currentPrefixChanged();
-    
-    qDebug() << "New prefix for player:" << m_currentPrefix;
-    
-    m_difficulty = m_game->getCurrentDifficulty();
-    emit difficultyChanged();
-    
-    // Calculate top solves for the new prefix
-    updateTopSolves();
+
+    // A move-now request only applies to the AI turn dispatched after it is cleared
+    m_game->clearMoveNow();
+    m_aiThinking = true;
+    emit aiThinkingChanged();
+    startEngineJob(EngineJobKind::AITurn, std::string());
 }
 
 void GameController::updateTopSolves()
 {
+    TRACE_SPAN("GameController::updateTopSolves");
     if (!m_game) return;
     
-    // Get top moves
-    auto topMoves = m_game->getTopAIMoves(m_currentPrefix.toStdString(), TOP_MOVES_TO_SHOW);
-    
-    m_topSolves.clear();
-    for (const auto& move : topMoves) {
-        QVariantMap moveMap;
-        moveMap["word"] = QString::fromStdString(move.word);
-        moveMap["createsPrefixSolutions"] = move.creates_prefix_solutions;
-        m_topSolves.append(moveMap);
+    startEngineJob(EngineJobKind::Solves, m_currentPrefix.toStdString());
+}
+
+namespace {
+
+// Player words the AI reply is precomputed for, best guesses first
+const size_t MAX_SPECULATED_WORDS = 8;
+
+// Runs on a worker thread; the controller guarantees nothing else touches `game`
+EngineJobResult runEngineJob(ShiritoriGame* game, quint64 jobId, EngineJobKind kind, std::string prefix,
+                             std::vector<std::string> words, std::shared_ptr<std::atomic<bool>> cancel)
+{
+    static const char* const spanNames[] = {"engine job: AI turn", "engine job: solves", "engine job: speculation"};
+    TraceSpan span(spanNames[static_cast<int>(kind)]);
+    if (trace_enabled()) trace_set_thread_name("engine job");
+
+    EngineJobResult result;
+    result.jobId = jobId;
+    result.kind = kind;
+
+    if (kind == EngineJobKind::Speculation) {
+        game->speculateReplies(words, cancel.get());
+        result.cancelled = cancel->load();
+        return result;
     }
-    
-    qDebug() << "Top solves calculated:" << m_topSolves.size() << "words for prefix" << m_currentPrefix;
-    
-    // Get regular solves
-    auto regularMoves = m_game->getRegularSolves(m_currentPrefix.toStdString(), 5);
-    
-    m_regularSolves.clear();
-    for (const auto& move : regularMoves) {
+
+    game->resetTurnProfile();
+    result.profiled = true;
+
+    if (kind == EngineJobKind::AITurn) {
+        result.aiWord.assign(game->getAIMove(cancel.get()));
+        if (result.aiWord.empty()) {
+            result.cancelled = cancel->load();
+            return result;
+        }
+        const SearchStats& stats = game->getLastSearchStats();
+        if (game->getAIEngine() == AIEngine::Search && stats.best_word == result.aiWord) {
+            qDebug() << "Search: depth" << stats.depth_reached << "nodes" << stats.nodes
+                     << "table hits" << stats.table_hits << "in" << stats.elapsed_ms << "ms,"
+                     << static_cast<long long>(stats.nodes_per_second) << "nodes/s";
+        }
+        const MonteCarloStats& mcts = game->getLastMonteCarloStats();
+        if (game->getAIEngine() == AIEngine::MonteCarlo && mcts.best_word == result.aiWord) {
+            qDebug() << "Monte Carlo:" << mcts.playouts << "playouts, tree" << mcts.tree_nodes
+                     << "nodes, depth" << mcts.tree_depth << "in" << mcts.elapsed_ms << "ms,"
+                     << static_cast<long long>(mcts.playouts_per_second) << "playouts/s, win rate"
+                     << mcts.best_win_rate;
+        }
+        result.prefix = game->getCurrentPrefix();
+        result.difficulty = game->getCurrentDifficulty();
+        prefix = result.prefix;
+        if (prefix.empty()) return result;
+    }
+
+    result.topMoves = game->getTopAIMoves(prefix, TOP_MOVES_TO_SHOW, cancel.get());
+    if (cancel->load()) {
+        result.cancelled = true;
+        return result;
+    }
+    result.regularMoves = game->getRegularSolves(prefix, 5);
+    result.hasSolves = true;
+    return result;
+}
+
+QVariantList toSolveList(const std::vector<WordRank>& moves)
+{
+    QVariantList list;
+    for (const auto& move : moves) {
         QVariantMap moveMap;
         moveMap["word"] = QString::fromStdString(move.word);
         moveMap["createsPrefixSolutions"] = move.creates_prefix_solutions;
-        m_regularSolves.append(moveMap);
+        list.append(moveMap);
     }
+    return list;
+}
+
+} // namespace
+
+void GameController::startEngineJob(EngineJobKind kind, const std::string& prefix,
+                                    const std::vector<std::string>& words)
+{
+    finishPendingJob(true);
+
+    m_activeJobId = m_nextJobId++;
+    m_activeJobKind = kind;
+    m_jobCancel = std::make_shared<std::atomic<bool>>(false);
+    m_jobWatcher.setFuture(QtConcurrent::run(runEngineJob, m_game, m_activeJobId, kind,
+                                             prefix, words, m_jobCancel));
+}
+
+// Precomputes the AI's answer to the player's most likely words, starting
+// with the top solves and then the regular ones, while the player thinks
+void GameController::startSpeculation(const EngineJobResult& solves)
+{
+    if (solves.cancelled || !solves.hasSolves) return;
+
+    std::vector<std::string> words;
+    for (const auto* moves : {&solves.topMoves, &solves.regularMoves}) {
+        for (const auto& move : *moves) {
+            if (words.size() >= MAX_SPECULATED_WORDS) break;
+            if (std::find(words.begin(), words.end(), move.word) == words.end()) {
+                words.push_back(move.word);
+            }
+        }
+    }
+    if (words.empty()) return;
+
+    startEngineJob(EngineJobKind::Speculation, std::string(), words);
+}
+
+// Blocks until the active job is done. A cancelled job stops at its next
+// checkpoint; unless `discard` is set, whatever it already committed to the
+// game (an AI word) is still reflected in the controller. Speculation has
+// nothing worth waiting for and is always cut short.
+void GameController::finishPendingJob(bool cancel, bool discard)
+{
+    if (m_activeJobId == 0) return;
+
+    if (cancel || m_activeJobKind == EngineJobKind::Speculation) m_jobCancel->store(true);
+    m_jobWatcher.waitForFinished();
+
+    EngineJobResult result = m_jobWatcher.result();
+    if (discard) {
+        m_activeJobId = 0;
+        if (m_aiThinking) {
+            m_aiThinking = false;
+            emit aiThinkingChanged();
+        }
+        return;
+    }
+    applyEngineJobResult(result);
+}
+
+void GameController::onEngineJobFinished()
+{
+    EngineJobResult result = m_jobWatcher.result();
+    // Results of jobs already finished or cancelled synchronously are stale
+    if (result.jobId != m_activeJobId) return;
+    applyEngineJobResult(result);
+    startSpeculation(result);
+}
+
+void GameController::applyEngineJobResult(const EngineJobResult& result)
+{
+    m_activeJobId = 0;
+
+    if (result.kind == EngineJobKind::Speculation) return;
+
+    // The game is idle until the next job starts, so its profile is safe to read
+    if (result.profiled && TURN_PROFILING_ENABLED) {
+        m_turnProfile = m_game->getTurnProfile();
+        emit turnProfileChanged();
+    }
+
+    if (result.kind == EngineJobKind::AITurn) {
+        if (m_aiThinking) {
+            m_aiThinking = false;
+            emit aiThinkingChanged();
+        }
+
+        if (result.aiWord.empty()) {
+            if (result.cancelled) return;
+            qDebug() << "AI has no valid move - player wins";
+            emit gameOver(true); // Player wins
+            return;
+        }
+
+        m_aiWords.append(QString::fromStdString(result.aiWord));
+        emit aiWordsChanged();
+        
+        qDebug() << "AI played:" << QString::fromStdString(result.aiWord);
+        
+        if (result.prefix.empty()) {
+            qDebug() << "No valid prefix - AI wins";
+            emit gameOver(false); // AI wins
+            return;
+        }
+        
+        // Update prefix for next player turn
+        m_currentPrefix = QString::fromStdString(result.prefix);
+        emit currentPrefixChanged();
+        
+        qDebug() << "New prefix for player:" << m_currentPrefix;
+        
+        m_difficulty = result.difficulty;
+        emit difficultyChanged();
+    }
+
+    if (result.cancelled || !result.hasSolves) return;
+
+    m_topSolves = toSolveList(result.topMoves);
+    qDebug() << "Top solves calculated:" << m_topSolves.size() << "words for prefix" << m_currentPrefix;
     
+    m_regularSolves = toSolveList(result.regularMoves);
     qDebug() << "Regular solves calculated:" << m_regularSolves.size() << "words for prefix" << m_currentPrefix;
     
     // Emit signals to notify QML
@@ -218,10 +450,40 @@ void GameController::updateTopSolves()
     emit regularSolvesChanged();
 }
 
+// Only called while no engine job runs, so the game is safe to read
+void GameController::syncPlayerStats()
+{
+    m_playerHearts = m_game->getPlayerHearts();
+    m_playerPoints = m_game->getPlayerPoints();
+    emit playerHeartsChanged();
+    emit playerPointsChanged();
+}
+
+void GameController::syncSpeculationStats()
+{
+    m_speculationHits = m_game->getSpeculationHits();
+    m_speculationMisses = m_game->getSpeculationMisses();
+    emit speculationStatsChanged();
+}
+
+QVariantMap GameController::turnProfile() const
+{
+    QVariantMap map;
+    map["enabled"] = TURN_PROFILING_ENABLED;
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        map[QString(turn_phase_name(phase)) + "Ms"] = m_turnProfile.phase_ns[phase] / 1e6;
+    }
+    map["candidates"] = static_cast<double>(m_turnProfile.candidates);
+    map["entriesScanned"] = static_cast<double>(m_turnProfile.entries_scanned);
+    map["usedProbes"] = static_cast<double>(m_turnProfile.used_probes);
+    return map;
+}
+
 QStringList GameController::getFullWordChain()
 {
     QStringList out;
     if (!m_game) return out;
+    finishPendingJob(false);
     const auto& chain = m_game->getWordChain();
     for (const auto& s : chain) out.append(QString::fromStdString(s));
     return out;
@@ -260,6 +522,7 @@ void GameController::resetGame()
     
     qDebug() << "Resetting game";
     
+    finishPendingJob(true, true);
     m_game->reset_game();
     m_playerWords.clear();
     m_aiWords.clear();
@@ -269,8 +532,7 @@ void GameController::resetGame()
     m_topSolvesHistory.clear();
     m_playerWordHistory.clear();
     
-    emit playerHeartsChanged();
-    emit playerPointsChanged();
+    syncPlayerStats();
     emit playerWordsChanged();
     emit aiWordsChanged();
     emit currentPrefixChanged();
@@ -284,6 +546,7 @@ void GameController::resetGame()
 void GameController::endGame()
 {
     qDebug() << "Game ended by player";
+    finishPendingJob(true, true);
     emit gameOver(false); // Player surrendered, AI wins
 }
 
@@ -293,13 +556,15 @@ void GameController::onHeartLoss()
     
     qDebug() << "Heart lost - updating backend, generating new prefix and resetting difficulty";
 
+    // Top solves still being ranked for the old prefix are stale now
+    finishPendingJob(true);
+
     // Decrement player heart in backend and reset points/difficulty counters
     m_game->losePlayerHeart();
-    emit playerHeartsChanged();
-    emit playerPointsChanged();
+    syncPlayerStats();
 
     // If player has no hearts left, end game
-    if (m_game->getPlayerHearts() <= 0) {
+    if (m_playerHearts <= 0) {
         emit gameOver(false);
         return;
     }
@@ -324,3 +589,59 @@ void GameController::onHeartLoss()
     
     qDebug() << "New prefix set to:" << m_currentPrefix << "with difficulty 1";
 }
+
+QString GameController::aiEngine() const
+{
+    switch (m_aiEngine) {
+    case AIEngine::Search: return "search";
+    case AIEngine::MonteCarlo: return "mcts";
+    default: return "heuristic";
+    }
+}
+
+void GameController::setAIEngine(const QString& engine)
+{
+    AIEngine selected = AIEngine::Heuristic;
+    if (engine == "search") selected = AIEngine::Search;
+    else if (engine == "mcts") selected = AIEngine::MonteCarlo;
+    if (selected == m_aiEngine) return;
+
+    // The engine is read by the job thread; let the current job finish first
+    finishPendingJob(false);
+    m_aiEngine = selected;
+    if (m_game) m_game->setAIEngine(m_aiEngine);
+    qDebug() << "AI engine set to" << aiEngine();
+    emit aiEngineChanged();
+}
+
+void GameController::setSearchBudget(int maxDepth, int timeBudgetMs)
+{
+    finishPendingJob(false);
+    m_searchConfig.max_depth = maxDepth;
+    m_searchConfig.time_budget_ms = timeBudgetMs;
+    if (m_game) {
+        m_game->setSearchConfig(m_searchConfig);
+        m_searchConfig = m_game->getSearchConfig();
+    }
+    qDebug() << "Search budget:" << m_searchConfig.max_depth << "plies," << m_searchConfig.time_budget_ms << "ms";
+}
+
+void GameController::setMonteCarloBudget(int difficulty, int budgetMs)
+{
+    if (difficulty < 1 || difficulty > 4) return;
+
+    finishPendingJob(false);
+    m_monteCarloConfig.budget_ms[difficulty - 1] = budgetMs;
+    if (m_game) {
+        m_game->setMonteCarloConfig(m_monteCarloConfig);
+        m_monteCarloConfig = m_game->getMonteCarloConfig();
+    }
+    qDebug() << "Monte Carlo budget for difficulty" << difficulty << ":"
+             << m_monteCarloConfig.budget_ms[difficulty - 1] << "ms";
+}
+
+void GameController::playAIMoveNow()
+{
+    // Safe while the AI job runs; the engine plays its best move so far
+    if (m_game && m_aiThinking) m_game->requestMoveNow();
+}
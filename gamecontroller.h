@@ -5,10 +5,34 @@
 #include <QString>
 #include <QStringList>
 #include <QVariantList>
+#include <QVariantMap>
+#include <QFutureWatcher>
 #include "shiritorigame.h"
 #include <QList>
+#include <atomic>
+#include <memory>
 #include <vector>
 
+enum class EngineJobKind {
+    AITurn,         // getAIMove, then rank solves for the new prefix
+    Solves,         // rank solves for a given prefix
+    Speculation     // precompute AI replies to likely player words
+};
+
+// Output of one background engine job, applied back on the GUI thread
+struct EngineJobResult {
+    quint64 jobId = 0;
+    EngineJobKind kind = EngineJobKind::Solves;
+    bool cancelled = false;
+    bool hasSolves = false;
+    bool profiled = false;      // the game's turn profile covers this job
+    std::string aiWord;
+    std::string prefix;
+    int difficulty = 1;
+    std::vector<WordRank> topMoves;
+    std::vector<WordRank> regularMoves;
+};
+
 class GameController : public QObject
 {
     Q_OBJECT
@@ -23,14 +47,23 @@ class GameController : public QObject
     Q_PROPERTY(QStringList aiWords READ aiWords NOTIFY aiWordsChanged)
     Q_PROPERTY(QString gameStatus READ gameStatus NOTIFY gameStatusChanged)
     Q_PROPERTY(int difficulty READ difficulty NOTIFY difficultyChanged)
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+    Q_PROPERTY(bool aiThinking READ aiThinking NOTIFY aiThinkingChanged)
+    Q_PROPERTY(int speculationHits READ speculationHits NOTIFY speculationStatsChanged)
+    Q_PROPERTY(int speculationMisses READ speculationMisses NOTIFY speculationStatsChanged)
+    // "heuristic", "search" or "mcts"
+    Q_PROPERTY(QString aiEngine READ aiEngine WRITE setAIEngine NOTIFY aiEngineChanged)
+    // Phase timings (ms) and scan counters of the last AI turn or solve
+    // ranking; "enabled" is false unless built with SHIRITORI_PROFILING
+    Q_PROPERTY(QVariantMap turnProfile READ turnProfile NOTIFY turnProfileChanged)
 
 public:
     explicit GameController(QObject *parent = nullptr);
     ~GameController();
 
     // Property getters
-    int playerHearts() const { return m_game ? m_game->getPlayerHearts() : 2; }
-    int playerPoints() const { return m_game ? m_game->getPlayerPoints() : 0; }
+    int playerHearts() const { return m_playerHearts; }
+    int playerPoints() const { return m_playerPoints; }
     QString currentPrefix() const { return m_currentPrefix; }
     QVariantList topSolves() const { return m_topSolves; }
     QVariantList regularSolves() const { return m_regularSolves; }
@@ -38,14 +71,24 @@ public:
     QStringList aiWords() const { return m_aiWords; }
     QString gameStatus() const { return m_gameStatus; }
     int difficulty() const { return m_difficulty; }
+    bool loading() const { return m_loading; }
+    bool aiThinking() const { return m_aiThinking; }
+    int speculationHits() const { return m_speculationHits; }
+    int speculationMisses() const { return m_speculationMisses; }
+    QString aiEngine() const;
+    void setAIEngine(const QString& engine);
+    QVariantMap turnProfile() const;
 
     // Invokable methods (callable from QML)
-    Q_INVOKABLE bool loadDatabase(const QString& dictPath, const QString& patternsPath);
+    Q_INVOKABLE void loadDatabaseAsync(const QString& dictPath, const QString& patternsPath);
     Q_INVOKABLE void startNewGame();
     Q_INVOKABLE bool submitWord(const QString& word);
     Q_INVOKABLE void resetGame();
     Q_INVOKABLE void endGame();
     Q_INVOKABLE void onHeartLoss();
+    Q_INVOKABLE void setSearchBudget(int maxDepth, int timeBudgetMs);
+    Q_INVOKABLE void setMonteCarloBudget(int difficulty, int budgetMs);
+    Q_INVOKABLE void playAIMoveNow();
     Q_INVOKABLE QStringList getFullWordChain();
     Q_INVOKABLE int topSolvesHistorySize() const;
     Q_INVOKABLE QVariantList topSolvesForIndex(int idx) const;
@@ -62,6 +105,13 @@ signals:
     void aiWordsChanged();
     void gameStatusChanged();
     void difficultyChanged();
+    void loadingChanged();
+    void aiThinkingChanged();
+    void speculationStatsChanged();
+    void aiEngineChanged();
+    void turnProfileChanged();
+    void loadProgress(const QString& phase, int count, int elapsedMs);
+    void databaseLoaded(bool success);
     void wordInvalid(const QString& reason);
     void topSolveAchieved();
     void gameOver(bool playerWon);
@@ -77,9 +127,40 @@ private:
     QStringList m_aiWords;
     QString m_gameStatus;
     int m_difficulty;
+    // Copies of the game's counters for QML, which may read them while a
+    // speculation job is playing moves on m_game and taking them back
+    int m_playerHearts;
+    int m_playerPoints;
+    int m_speculationHits;
+    int m_speculationMisses;
+    bool m_loading;
+    QFutureWatcher<ShiritoriGame*> m_loadWatcher;
+    // Applied to every game, including ones loaded later
+    AIEngine m_aiEngine;
+    SearchConfig m_searchConfig;
+    MonteCarloConfig m_monteCarloConfig;
+    TurnProfile m_turnProfile;
+
+    // At most one engine job runs at a time; the GUI thread only touches
+    // m_game once that job has been finished or cancelled
+    bool m_aiThinking;
+    quint64 m_nextJobId;
+    quint64 m_activeJobId;
+    EngineJobKind m_activeJobKind;
+    std::shared_ptr<std::atomic<bool>> m_jobCancel;
+    QFutureWatcher<EngineJobResult> m_jobWatcher;
 
+    void onDatabaseLoadFinished();
+    void startEngineJob(EngineJobKind kind, const std::string& prefix,
+                        const std::vector<std::string>& words = std::vector<std::string>());
+    void startSpeculation(const EngineJobResult& solves);
+    void finishPendingJob(bool cancel, bool discard = false);
+    void onEngineJobFinished();
+    void applyEngineJobResult(const EngineJobResult& result);
     void updateTopSolves();
     void processAITurn();
+    void syncPlayerStats();
+    void syncSpeculationStats();
 };
 
 #endif // GAMECONTROLLER_H
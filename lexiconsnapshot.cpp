@@ -0,0 +1,313 @@
+#include "lexiconsnapshot.h"
+#include "shiritorigame.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'S', 'H', 'I', 'R', 'S', 'N', 'A', 'P'};
+const uint32_t SNAPSHOT_VERSION = 3;
+
+enum SnapshotSectionId {
+  SECTION_DICT_CHARS,
+  SECTION_DICT_OFFSETS,
+  SECTION_PREFIX_RANGES,
+  SECTION_PREFIX_FLAGS,
+  SECTION_WORD_FEATURES,
+  SECTION_OBSCURITY_POSTINGS,
+  SECTION_OBSCURITY_RANKS,
+  SECTION_LENGTH_POSTINGS,
+  SECTION_LENGTH_RANKS,
+  SECTION_COUNT
+};
+
+struct SnapshotSection {
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t dict_count;
+  uint64_t reserved;
+  uint64_t layout_hash;
+  uint64_t source_checksum;
+  uint64_t file_size;
+  SnapshotSection sections[SECTION_COUNT];
+};
+
+const uint64_t FNV_OFFSET = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+inline uint64_t fnv1a(uint64_t hash, const void* data, size_t len) {
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= p[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+// Anything that changes the meaning or shape of the stored tables must feed
+// into this hash, so stale snapshots from older builds are rebuilt. The
+// blacklist is hashed sorted, since unordered_set order is not stable.
+uint64_t layout_hash() {
+  const uint64_t shape[] = {
+    sizeof(PrefixRange), sizeof(WordFeatures), (uint64_t)PREFIX_TABLE_SIZE,
+    (uint64_t)MAX_PREFIX_LEN, (uint64_t)OBSCURE_THRESHOLD, (uint64_t)LEXICON_FEATURES_VERSION
+  };
+  uint64_t hash = fnv1a(FNV_OFFSET, shape, sizeof(shape));
+
+  std::vector<std::string> blacklist(BLACKLIST_SUFFIXES.begin(), BLACKLIST_SUFFIXES.end());
+  std::sort(blacklist.begin(), blacklist.end());
+  for (const auto& suffix : blacklist) {
+    hash = fnv1a(hash, suffix.c_str(), suffix.length() + 1);
+  }
+  return hash;
+}
+
+inline uint64_t align8(uint64_t n) {
+  return (n + 7) & ~uint64_t(7);
+}
+
+// Each slot's postings must lie in its prefix range, in strictly increasing
+// rank. With the ranks a permutation, that makes them exactly the range's
+// words, in the key order the posting cursors rely on.
+bool postings_match_ranges(const LexiconTables& tables, const uint32_t* postings, const uint32_t* ranks) {
+  const uint32_t count = tables.dict_count;
+  std::vector<uint8_t> rank_taken(count, 0);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (ranks[i] >= count || rank_taken[ranks[i]]) return false;
+    rank_taken[ranks[i]] = 1;
+  }
+  for (int slot = 0; slot < PREFIX_TABLE_SIZE; ++slot) {
+    const PrefixRange& range = tables.prefix_ranges[slot];
+    const uint32_t* block = postings + uint64_t(prefix_table_len(slot) - 1) * count;
+    for (uint32_t i = range.begin; i < range.end; ++i) {
+      if (block[i] < range.begin || block[i] >= range.end) return false;
+      if (i > range.begin && ranks[block[i]] <= ranks[block[i - 1]]) return false;
+    }
+  }
+  return true;
+}
+
+// The engine indexes with the mapped tables unchecked, so a snapshot whose
+// words, ranges, creates-prefixes or postings point outside the dictionary
+// or disagree with it is rejected here, once per load
+bool tables_in_bounds(const LexiconTables& tables) {
+  const uint32_t count = tables.dict_count;
+  for (uint32_t i = 0; i < count; ++i) {
+    if (tables.dict_offsets[i] > tables.dict_offsets[i + 1]) return false;
+  }
+  for (int i = 0; i < PREFIX_TABLE_SIZE; ++i) {
+    const PrefixRange& range = tables.prefix_ranges[i];
+    if (range.begin > range.end || range.end > count) return false;
+  }
+  // The creates-prefix is a suffix of its word and must name that suffix's
+  // slot. obscure_suffix_length counts the suffix letters probed, which a
+  // short word can fall below, so it is only bounded by MAX_PREFIX_LEN.
+  for (uint32_t i = 0; i < count; ++i) {
+    const WordFeatures& features = tables.word_features[i];
+    const uint32_t length = tables.dict_offsets[i + 1] - tables.dict_offsets[i];
+    const int len = features.creates_prefix_len;
+    if (len == 0 || len > MAX_PREFIX_LEN || static_cast<uint32_t>(len) > length) return false;
+    const char* suffix = tables.dict_chars + tables.dict_offsets[i + 1] - len;
+    if (features.creates_prefix_id != prefix_table_id(suffix, len)) return false;
+    if (features.obscure_suffix_length > MAX_PREFIX_LEN) return false;
+  }
+  return postings_match_ranges(tables, tables.obscurity_postings, tables.obscurity_ranks) &&
+         postings_match_ranges(tables, tables.length_postings, tables.length_ranks);
+}
+
+} // namespace
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& path) {
+  std::unique_ptr<MappedFile> file(new MappedFile());
+#if defined(_WIN32)
+  HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) return nullptr;
+  file->m_file = handle;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) return nullptr;
+
+  HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) return nullptr;
+  file->m_mapping = mapping;
+
+  const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) return nullptr;
+  file->m_data = static_cast<const char*>(view);
+  file->m_size = static_cast<size_t>(size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) return nullptr;
+  file->m_data = static_cast<const char*>(view);
+  file->m_size = static_cast<size_t>(st.st_size);
+#endif
+  return file;
+}
+
+MappedFile::~MappedFile() {
+#if defined(_WIN32)
+  if (m_data) UnmapViewOfFile(m_data);
+  if (m_mapping) CloseHandle(m_mapping);
+  if (m_file) CloseHandle(m_file);
+#else
+  if (m_data) munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
+
+uint64_t checksum_file(const std::string& path, bool& ok) {
+  std::ifstream in(path, std::ios::binary);
+  ok = static_cast<bool>(in);
+  if (!ok) return 0;
+
+  uint64_t hash = FNV_OFFSET;
+  std::vector<char> buffer(1 << 16);
+  while (in) {
+    in.read(buffer.data(), buffer.size());
+    hash = fnv1a(hash, buffer.data(), static_cast<size_t>(in.gcount()));
+  }
+  return hash;
+}
+
+bool write_lexicon_snapshot(const std::string& path, uint64_t source_checksum,
+    const LexiconTables& tables) {
+  SnapshotHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.dict_count = tables.dict_count;
+  header.layout_hash = layout_hash();
+  header.source_checksum = source_checksum;
+
+  const void* payload[SECTION_COUNT] = {
+    tables.dict_chars, tables.dict_offsets,
+    tables.prefix_ranges, tables.prefix_flags, tables.word_features,
+    tables.obscurity_postings, tables.obscurity_ranks, tables.length_postings, tables.length_ranks
+  };
+  const uint64_t sizes[SECTION_COUNT] = {
+    tables.dict_offsets[tables.dict_count],
+    (tables.dict_count + 1ull) * sizeof(uint32_t),
+    PREFIX_TABLE_SIZE * sizeof(PrefixRange),
+    PREFIX_TABLE_SIZE * sizeof(uint8_t),
+    tables.dict_count * sizeof(WordFeatures),
+    MAX_PREFIX_LEN * tables.dict_count * sizeof(uint32_t),
+    tables.dict_count * sizeof(uint32_t),
+    MAX_PREFIX_LEN * tables.dict_count * sizeof(uint32_t),
+    tables.dict_count * sizeof(uint32_t)
+  };
+
+  uint64_t offset = align8(sizeof(SnapshotHeader));
+  for (int s = 0; s < SECTION_COUNT; ++s) {
+    header.sections[s] = {offset, sizes[s]};
+    offset = align8(offset + sizes[s]);
+  }
+  header.file_size = offset;
+
+  // Write next to the target and swap it in, so a reader never maps half a file
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    const char padding[8] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t written = sizeof(header);
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+      out.write(padding, header.sections[s].offset - written);
+      out.write(static_cast<const char*>(payload[s]), sizes[s]);
+      written = header.sections[s].offset + sizes[s];
+    }
+    out.write(padding, header.file_size - written);
+    if (!out) {
+      out.close();
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+
+  std::remove(path.c_str());
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<MappedFile> map_lexicon_snapshot(const std::string& path,
+    bool check_source, uint64_t source_checksum, LexiconTables& tables) {
+  std::unique_ptr<MappedFile> file = MappedFile::open(path);
+  if (!file || file->size() < sizeof(SnapshotHeader)) return nullptr;
+
+  SnapshotHeader header;
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) return nullptr;
+  if (header.version != SNAPSHOT_VERSION || header.layout_hash != layout_hash()) return nullptr;
+  if (check_source && header.source_checksum != source_checksum) return nullptr;
+  if (header.file_size != file->size()) return nullptr;
+
+  const uint64_t expected[SECTION_COUNT] = {
+    0,
+    (header.dict_count + 1ull) * sizeof(uint32_t),
+    PREFIX_TABLE_SIZE * sizeof(PrefixRange),
+    PREFIX_TABLE_SIZE * sizeof(uint8_t),
+    header.dict_count * sizeof(WordFeatures),
+    MAX_PREFIX_LEN * header.dict_count * sizeof(uint32_t),
+    header.dict_count * sizeof(uint32_t),
+    MAX_PREFIX_LEN * header.dict_count * sizeof(uint32_t),
+    header.dict_count * sizeof(uint32_t)
+  };
+  for (int s = 0; s < SECTION_COUNT; ++s) {
+    const SnapshotSection& section = header.sections[s];
+    if (section.offset % 8 != 0 || section.offset > file->size() ||
+        section.size > file->size() - section.offset) {
+      return nullptr;
+    }
+    if (expected[s] != 0 && section.size != expected[s]) return nullptr;
+  }
+
+  const char* base = file->data();
+  tables.dict_count = header.dict_count;
+  tables.dict_chars = base + header.sections[SECTION_DICT_CHARS].offset;
+  tables.dict_offsets = reinterpret_cast<const uint32_t*>(base + header.sections[SECTION_DICT_OFFSETS].offset);
+  tables.prefix_ranges = reinterpret_cast<const PrefixRange*>(base + header.sections[SECTION_PREFIX_RANGES].offset);
+  tables.prefix_flags = reinterpret_cast<const uint8_t*>(base + header.sections[SECTION_PREFIX_FLAGS].offset);
+  tables.word_features = reinterpret_cast<const WordFeatures*>(base + header.sections[SECTION_WORD_FEATURES].offset);
+  tables.obscurity_postings = reinterpret_cast<const uint32_t*>(base + header.sections[SECTION_OBSCURITY_POSTINGS].offset);
+  tables.obscurity_ranks = reinterpret_cast<const uint32_t*>(base + header.sections[SECTION_OBSCURITY_RANKS].offset);
+  tables.length_postings = reinterpret_cast<const uint32_t*>(base + header.sections[SECTION_LENGTH_POSTINGS].offset);
+  tables.length_ranks = reinterpret_cast<const uint32_t*>(base + header.sections[SECTION_LENGTH_RANKS].offset);
+
+  // Offsets must stay inside the character block
+  if (tables.dict_offsets[tables.dict_count] != header.sections[SECTION_DICT_CHARS].size) return nullptr;
+  if (!tables_in_bounds(tables)) return nullptr;
+  return file;
+}
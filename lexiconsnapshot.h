@@ -0,0 +1,133 @@
+#ifndef LEXICONSNAPSHOT_H
+#define LEXICONSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PrefixRange;
+struct WordFeatures;
+
+// Read-only view of a file mapped into memory; unmapped on destruction
+class MappedFile {
+public:
+    static std::unique_ptr<MappedFile> open(const std::string& path);
+    ~MappedFile();
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+// Read-only table that either owns its storage or views a mapped snapshot
+template <typename T>
+class LexiconTable {
+public:
+    void adopt(std::vector<T>&& values) {
+        m_owned = std::move(values);
+        m_data = m_owned.data();
+        m_size = m_owned.size();
+    }
+    void view(const T* data, size_t size) {
+        m_owned = std::vector<T>();
+        m_data = data;
+        m_size = size;
+    }
+    void clear() { view(nullptr, 0); }
+
+    const T& operator[](size_t i) const { return m_data[i]; }
+    const T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+private:
+    std::vector<T> m_owned;
+    const T* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+// Word list stored back to back in one character arena with count + 1
+// offsets, so word IDs index it directly and neighbouring IDs share cache
+// lines. Like LexiconTable it owns its arena or views a mapped snapshot.
+class WordPool {
+public:
+    void adopt(std::vector<char>&& chars, std::vector<uint32_t>&& offsets) {
+        m_chars.adopt(std::move(chars));
+        m_offsets.adopt(std::move(offsets));
+    }
+    void view(const char* chars, const uint32_t* offsets, size_t count) {
+        m_chars.view(chars, count ? offsets[count] : 0);
+        m_offsets.view(offsets, count + 1);
+    }
+    void clear() {
+        m_chars.clear();
+        m_offsets.clear();
+    }
+
+    std::string_view operator[](size_t i) const {
+        return std::string_view(m_chars.data() + m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
+    }
+    size_t size() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+    const char* chars() const { return m_chars.data(); }
+    const uint32_t* offsets() const { return m_offsets.data(); }
+    size_t bytes() const { return m_chars.size() + m_offsets.size() * sizeof(uint32_t); }
+
+    // First ID in [first, last) whose word is not less than `key`; the pool
+    // must be sorted
+    uint32_t lower_bound(std::string_view key, uint32_t first, uint32_t last) const {
+        while (first < last) {
+            uint32_t mid = first + (last - first) / 2;
+            if ((*this)[mid] < key) first = mid + 1;
+            else last = mid;
+        }
+        return first;
+    }
+
+private:
+    LexiconTable<char> m_chars;
+    LexiconTable<uint32_t> m_offsets;
+};
+
+// Flat views of everything load_database derives from the text dictionary.
+// Word strings are stored back to back in `chars` with word_count + 1 offsets.
+struct LexiconTables {
+    const char* dict_chars = nullptr;
+    const uint32_t* dict_offsets = nullptr;
+    uint32_t dict_count = 0;
+    const PrefixRange* prefix_ranges = nullptr;
+    const uint8_t* prefix_flags = nullptr;
+    const WordFeatures* word_features = nullptr;
+    // MAX_PREFIX_LEN * dict_count posting entries and dict_count ranks each
+    const uint32_t* obscurity_postings = nullptr;
+    const uint32_t* obscurity_ranks = nullptr;
+    const uint32_t* length_postings = nullptr;
+    const uint32_t* length_ranks = nullptr;
+};
+
+// FNV-1a over the whole file; `ok` is false when the file cannot be read
+uint64_t checksum_file(const std::string& path, bool& ok);
+
+// Snapshots are a native-endian cache of one dictionary file. They carry the
+// checksum of that file and a hash of the table layout, and are rejected when
+// either no longer matches.
+bool write_lexicon_snapshot(const std::string& path, uint64_t source_checksum,
+    const LexiconTables& tables);
+std::unique_ptr<MappedFile> map_lexicon_snapshot(const std::string& path,
+    bool check_source, uint64_t source_checksum, LexiconTables& tables);
+
+#endif // LEXICONSNAPSHOT_H
@@ -2,10 +2,18 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include "gamecontroller.h"
+#include "tracing.h"
 
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
+
+    // SHIRITORI_TRACE=<file> records a Chrome trace of the session into <file>
+    const QByteArray tracePath = qgetenv("SHIRITORI_TRACE");
+    if (!tracePath.isEmpty()) {
+        trace_set_thread_name("GUI");
+        trace_start();
+    }
     
     // Create game controller
     GameController gameController;
@@ -23,5 +31,10 @@ int main(int argc, char *argv[])
     if (engine.rootObjects().isEmpty())
         return -1;
     
-    return app.exec();
+    int status = app.exec();
+    if (!tracePath.isEmpty()) {
+        trace_stop();
+        trace_write_chrome_json(tracePath.toStdString());
+    }
+    return status;
 }
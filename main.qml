@@ -29,11 +29,14 @@ ApplicationWindow {
     property bool showWordChainDialog: false
     property bool showWordChoicesDialog: false
     property string chosenDictPath: ""
+    property bool startAfterLoad: false
     property var wordChainModel: []
     property var wordChoicesSnapshots: []  // Change from var to specific type
     property bool showAlreadyUsedAnimation: false
     property bool showSolvesMode: false
     property var previousTopSolves: []
+    property string loadProgressText: ""
+    property bool showTurnProfile: false
 
     // Sound Effects
     SoundEffect {
@@ -68,6 +71,16 @@ ApplicationWindow {
         return 5  // difficulty 4
     }
 
+    function startGameplay() {
+        gameController.startNewGame()
+        currentScreen = "gameplay"
+        localPlayerHearts = gameController.playerHearts
+        maxTime = getMaxTimeForDifficulty(gameController.difficulty)
+        timeRemaining = maxTime
+        timerRunning = true
+        Qt.callLater(function() { userInput.forceActiveFocus() })
+    }
+
     // Update max time when difficulty changes
     onVisibleChanged: {
         if (visible && currentScreen === "gameplay") {
@@ -400,6 +413,21 @@ onShowWordChoicesDialogChanged: {
         function onCurrentPrefixChanged() {
           shouldShowTopSolves = false
         }
+
+        function onLoadProgress(phase, count, elapsedMs) {
+            loadProgressText = "Loading " + phase + "... " + count + " (" + elapsedMs + " ms)"
+        }
+
+        function onDatabaseLoaded(success) {
+            loadProgressText = ""
+            if (!success) {
+                console.log("Failed to load dict:", chosenDictPath)
+            } else if (startAfterLoad) {
+                startGameplay()
+            } else {
+                console.log("Loaded dict:", chosenDictPath)
+            }
+        }
         
         function onTopSolveAchieved() {
             showTopSolveNotification = true
@@ -466,7 +494,8 @@ onShowWordChoicesDialogChanged: {
         id: gameTimer
         interval: 100
         repeat: true
-        running: timerRunning
+        // The player's clock waits while the AI works out its reply
+        running: timerRunning && !gameController.aiThinking
         onTriggered: {
           timeRemaining -= 0.1
           if (timeRemaining <= 0) {
@@ -583,6 +612,45 @@ onShowWordChoicesDialogChanged: {
         font.family: "Comic Neue"
       }
     }
+    // Turn profile debug overlay (F3), only in builds with SHIRITORI_PROFILING
+    Shortcut {
+      sequence: "F3"
+      enabled: gameController.turnProfile.enabled
+      onActivated: showTurnProfile = !showTurnProfile
+    }
+
+    Rectangle {
+      id: turnProfileOverlay
+      x: 12
+      y: 12
+      width: turnProfileText.implicitWidth + 20
+      height: turnProfileText.implicitHeight + 16
+      color: "#cc000000"
+      radius: 6
+      visible: currentScreen === "gameplay" && showTurnProfile && gameController.turnProfile.enabled
+      z: 1001
+
+      Text {
+        id: turnProfileText
+        anchors.centerIn: parent
+        text: {
+          var p = gameController.turnProfile
+          var phases = ["collect", "score", "sort", "lookahead", "topSolves", "regularSolves"]
+          var lines = []
+          for (var i = 0; i < phases.length; i++) {
+            lines.push(phases[i] + ": " + p[phases[i] + "Ms"].toFixed(2) + " ms")
+          }
+          lines.push("candidates: " + p.candidates)
+          lines.push("entries scanned: " + p.entriesScanned)
+          lines.push("used probes: " + p.usedProbes)
+          return lines.join("\n")
+        }
+        font.pixelSize: 13
+        font.family: "monospace"
+        color: "#9acd32"
+      }
+    }
+
     // File dialog & drop area for loading custom dictionary files
     FileDialog {
         id: fileDialog
@@ -592,10 +660,9 @@ onShowWordChoicesDialogChanged: {
             if (fileDialog.fileUrls.length > 0) {
                 var f = fileDialog.fileUrls[0].toLocalFile()
                 chosenDictPath = f
-                // attempt to load; patterns path left empty
-                var ok = gameController.loadDatabase(f, "")
-                if (ok) console.log("Loaded dict:", f)
-                else console.log("Failed to load dict:", f)
+                // Loads on a worker thread; onDatabaseLoaded reports the outcome
+                startAfterLoad = false
+                gameController.loadDatabaseAsync(f, "./Dictionary/rare_prefix.txt")
             }
         }
     }
@@ -652,6 +719,7 @@ onShowWordChoicesDialogChanged: {
 
               // Show Solves mode button
               Button {
+                enabled: !gameController.loading
                 Layout.preferredWidth: 360
                 Layout.preferredHeight: 70
                 background: Rectangle {
@@ -687,23 +755,16 @@ onShowWordChoicesDialogChanged: {
                   var dictPath = "./Dictionary/last_letter.txt"
                   var patternPath = "./Dictionary/rare_prefix.txt"
                   chosenDictPath = dictPath
+                  startAfterLoad = true
 
-                  if (gameController.loadDatabase(dictPath, patternPath)) {
-                    gameController.startNewGame()
-                    currentScreen = "gameplay"
-                    localPlayerHearts = gameController.playerHearts
-                    maxTime = getMaxTimeForDifficulty(gameController.difficulty)
-                    timeRemaining = maxTime
-                    timerRunning = true
-                    Qt.callLater(function() { userInput.forceActiveFocus() })
-                  } else {
-                    console.log("Failed to load default dict")
-                  }
+                  // Gameplay starts from onDatabaseLoaded once the worker finishes
+                  gameController.loadDatabaseAsync(dictPath, patternPath)
                 }
               }
 
               // No Show Solves mode button
               Button {
+                enabled: !gameController.loading
                 Layout.preferredWidth: 360
                 Layout.preferredHeight: 70
                 background: Rectangle {
@@ -739,21 +800,22 @@ onShowWordChoicesDialogChanged: {
                   var dictPath = "./Dictionary/last_letter.txt"
                   var patternPath = "./Dictionary/rare_prefix.txt"
                   chosenDictPath = dictPath
+                  startAfterLoad = true
 
-                  if (gameController.loadDatabase(dictPath, patternPath)) {
-                    gameController.startNewGame()
-                    currentScreen = "gameplay"
-                    localPlayerHearts = gameController.playerHearts
-                    maxTime = getMaxTimeForDifficulty(gameController.difficulty)
-                    timeRemaining = maxTime
-                    timerRunning = true
-                    Qt.callLater(function() { userInput.forceActiveFocus() })
-                  } else {
-                    console.log("Failed to load default dict")
-                  }
+                  // Gameplay starts from onDatabaseLoaded once the worker finishes
+                  gameController.loadDatabaseAsync(dictPath, patternPath)
                 }
               }
           }
+
+            Text {
+              visible: gameController.loading
+              text: loadProgressText === "" ? "Loading..." : loadProgressText
+              font.pixelSize: 20
+              color: "#7a7a7a"
+              Layout.alignment: Qt.AlignHCenter
+              font.family: "Comic Neue"
+            }
         }
       }
     }
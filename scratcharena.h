@@ -0,0 +1,114 @@
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Bump allocator for the scratch memory of one turn. Allocations are carved
+// out of one retained block and only freed when the outermost Scope ends. A
+// turn that outgrows the block borrows from the heap, and the block grows to
+// cover it once the turn is over, so after warm-up turns allocate nothing.
+// Not thread-safe; scopes must nest.
+class ScratchArena {
+public:
+    ScratchArena() = default;
+    ~ScratchArena() { release_overflow(); }
+
+    void* allocate(size_t bytes, size_t align) {
+        size_t start = (m_used + align - 1) & ~(align - 1);
+        if (start + bytes <= m_capacity) {
+            m_used = start + bytes;
+            return m_block.get() + start;
+        }
+        // Overflow chunks keep their successor in a header in front of the data
+        const size_t header = (sizeof(Overflow) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        Overflow* chunk = static_cast<Overflow*>(::operator new(header + bytes));
+        chunk->next = m_overflow;
+        m_overflow = chunk;
+        m_overflow_bytes += bytes + align;
+        return reinterpret_cast<unsigned char*>(chunk) + header;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    // Frees everything allocated while it was alive
+    class Scope {
+    public:
+        explicit Scope(ScratchArena& arena) : m_arena(arena), m_mark(arena.m_used) { ++arena.m_depth; }
+        ~Scope() {
+            m_arena.m_used = m_mark;
+            if (--m_arena.m_depth == 0) m_arena.end_turn();
+        }
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ScratchArena& m_arena;
+        size_t m_mark;
+    };
+
+private:
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    struct Overflow {
+        Overflow* next;
+    };
+
+    void end_turn() {
+        if (!m_overflow) return;
+        const size_t needed = m_capacity + m_overflow_bytes;
+        release_overflow();
+        m_capacity = std::max<size_t>(needed + needed / 2, 4096);
+        m_block.reset(new unsigned char[m_capacity]);
+    }
+
+    void release_overflow() {
+        while (m_overflow) {
+            Overflow* next = m_overflow->next;
+            ::operator delete(m_overflow);
+            m_overflow = next;
+        }
+        m_overflow_bytes = 0;
+    }
+
+    std::unique_ptr<unsigned char[]> m_block;
+    size_t m_capacity = 0;
+    size_t m_used = 0;
+    int m_depth = 0;
+    Overflow* m_overflow = nullptr;
+    size_t m_overflow_bytes = 0;
+};
+
+// Standard allocator over a ScratchArena; deallocation is a no-op
+template <typename T>
+class ScratchAllocator {
+public:
+    using value_type = T;
+
+    ScratchAllocator(ScratchArena& arena) : m_arena(&arena) {}
+    template <typename U>
+    ScratchAllocator(const ScratchAllocator<U>& other) : m_arena(other.arena()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    ScratchArena* arena() const { return m_arena; }
+    template <typename U>
+    bool operator==(const ScratchAllocator<U>& other) const { return m_arena == other.arena(); }
+    template <typename U>
+    bool operator!=(const ScratchAllocator<U>& other) const { return m_arena != other.arena(); }
+
+private:
+    ScratchArena* m_arena;
+};
+
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+#endif // SCRATCHARENA_H
@@ -1,15 +1,28 @@
-QT += quick core gui widgets
+QT += quick core gui widgets concurrent
 
 CONFIG += c++17
 
+# Per-turn phase timers and scan counters (GameController.turnProfile, F3 in game)
+# DEFINES += SHIRITORI_PROFILING
+
 SOURCES += \
     main.cpp \
     gamecontroller.cpp \
-    shiritorigame.cpp
+    lexiconsnapshot.cpp \
+    shiritorigame.cpp \
+    shiritorimcts.cpp \
+    shiritorisearch.cpp \
+    tracing.cpp \
+    workstealingpool.cpp
 
 HEADERS += \
     gamecontroller.h \
-    shiritorigame.h
+    lexiconsnapshot.h \
+    scratcharena.h \
+    shiritorigame.h \
+    tracing.h \
+    turnprofile.h \
+    workstealingpool.h
 
 RESOURCES += resources.qrc
 
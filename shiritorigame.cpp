@@ -1,4 +1,5 @@
 #include "shiritorigame.h"
+#include "tracing.h"
 #include <algorithm>
 #include <fstream>
 #include <sstream>
@@ -7,6 +8,18 @@
 #include <iostream>
 #include <map>
 #include <set>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// speculation_version value when no speculation covers the current turn
+static const uint64_t NO_SPECULATION = ~uint64_t(0);
+// CachedRanking epoch of an entry whose ranking was cancelled half way
+static const uint64_t NO_RANKING = ~uint64_t(0);
+// Past this many cached prefixes the ranking cache starts over
+static const size_t MAX_CACHED_RANKINGS = 256;
+// Rows a getTopAIMoves ranking keeps at most
+static const size_t MAX_RANKED_MOVES = 200;
 
 // Constructor
 ShiritoriGame::ShiritoriGame()
@@ -14,6 +27,17 @@ ShiritoriGame::ShiritoriGame()
   , turns_since_heart_loss(0)
   , player_hearts(STARTING_HEARTS)
     , player_points(0)
+  , used_epoch(0)
+  , next_ranking_entry(0)
+  , ranking_stamp(0)
+  , state_version(0)
+  , speculation_version(NO_SPECULATION)
+  , speculation_hits(0)
+  , speculation_misses(0)
+  , worker_threads(0)
+  , ai_engine(AIEngine::Heuristic)
+  , search_generation(0)
+  , move_now(false)
 {
   auto seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
   rng.seed(seed);
@@ -21,11 +45,6 @@ ShiritoriGame::ShiritoriGame()
 }
 
 // Helper functions
-inline std::string reverse_str(std::string s) {
-  std::reverse(s.begin(), s.end());
-  return s;
-}
-
 inline void to_lower_inplace(std::string& s) {
   for (char& c : s) c = std::tolower(static_cast<unsigned char>(c));
 }
@@ -45,19 +64,31 @@ std::string parse_word(const std::string& line) {
   return clean;
 }
 
-inline std::string get_suffix(const std::string& word, int len) {
-  return word.length() < static_cast<size_t>(len) ? word : word.substr(word.length() - len);
+inline std::string get_suffix(std::string_view word, int len) {
+  return std::string(word.length() < static_cast<size_t>(len) ? word : word.substr(word.length() - len));
+}
+
+inline int popcount64(uint64_t x) {
+#if defined(_MSC_VER)
+  return static_cast<int>(__popcnt64(x));
+#else
+  return __builtin_popcountll(x);
+#endif
 }
 
-inline int get_difficulty_level(int turns_since_reset) {
-  if (turns_since_reset <= 3) return 1;
-  else if (turns_since_reset <= 8) return 2;
-  else if (turns_since_reset <= 15) return 3;
-  else return 4;
+// Index of the lowest set bit; x must be non-zero
+inline int lowest_bit64(uint64_t x) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(x);
+#endif
 }
 
-inline double calculateObscurityScoreLocal(const std::string& prefix, int solution_count,
-    const std::vector<std::string>& solutions) {
+inline double calculateObscurityScoreLocal(std::string_view prefix, int solution_count,
+    size_t total_solution_len) {
   double score = (prefix.length() - 2) * 10.0;
 
   if (solution_count > 0) {
@@ -69,10 +100,8 @@ inline double calculateObscurityScoreLocal(const std::string& prefix, int soluti
     if (rare_letters.find(c) != std::string::npos) score += 15.0;
   }
 
-  if (!solutions.empty()) {
-    size_t total_len = 0;
-    for (const auto& sol : solutions) total_len += sol.length();
-    double avg_len = static_cast<double>(total_len) / solutions.size();
+  if (solution_count > 0) {
+    double avg_len = static_cast<double>(total_solution_len) / solution_count;
     score += (avg_len - 5.0) * 2.0;
   }
 
@@ -90,51 +119,70 @@ inline double calculateObscurityScoreLocal(const std::string& prefix, int soluti
   return score;
 }
 
-// Find best creates-prefix for a word
-std::pair<std::string,int> find_best_prefix_static_cached_local(const std::string& word,
-    const std::unordered_map<std::string,int>& prefix_count_cache,
-    const std::unordered_set<std::string>& blacklist,
-    const std::vector<std::string>& dict_list) {
-  std::string best_prefix = "";
-  int best_count = std::numeric_limits<int>::max();
+// getAIMove's total for a candidate whose creates-prefix is `prefix`
+inline double candidate_total(std::string_view prefix, const WordFeatures& features, int solution_count,
+    int max_solution_length, size_t total_solution_len, bool solved) {
+  double total = 0.0;
 
-  for (int len = std::min(MAX_PREFIX_LEN, (int)word.length()); len >= 1; --len) {
-    std::string prefix = get_suffix(word, len);
-    if (blacklist.count(prefix) > 0) continue;
-
-    bool self_solving = false;
-    auto it = std::lower_bound(dict_list.begin(), dict_list.end(), prefix);
-    while (it != dict_list.end() && it->rfind(prefix,0) == 0) {
-      if (it->length() >= prefix.length()) {
-        std::string sfx = get_suffix(*it, prefix.length());
-        if (sfx == prefix) { self_solving = true; break; }
-      }
-      ++it;
+  // Penalize heavily if no solutions
+  if (solution_count == 0) {
+    total = -10000.0;
+  } else {
+    total += 10000.0 / solution_count;
+    total += calculateObscurityScoreLocal(prefix, solution_count, total_solution_len) * 15.0;
+    total += (max_solution_length - 5) * 30.0;
+    // The word itself is obscure
+    if (features.obscure_suffix_length > 0) {
+      total += 1500.0 + features.obscure_suffix_length * 100.0;
     }
-    if (self_solving) continue;
+    total += prefix.length() * 50.0;
+  }
+
+  // Penalize blacklisted/self-solving but don't exclude
+  if (features.flags & (WORD_CREATES_BLACKLISTED | WORD_CREATES_SELF_SOLVING)) {
+    total -= 5000.0;
+  }
 
-    auto itc = prefix_count_cache.find(prefix);
-    int solutions = (itc != prefix_count_cache.end()) ? itc->second : 0;
+  // Penalize if already solved
+  if (solved) {
+    total -= 3000.0;
+  }
+  return total;
+}
+
+// Find best creates-prefix for a word: returns the suffix length and its solution count
+std::pair<int,int> find_best_prefix_static_cached_local(std::string_view word,
+    const PrefixRange* prefix_ranges, const uint8_t* prefix_flags) {
+  int best_len = 0;
+  int best_count = std::numeric_limits<int>::max();
+  const int max_len = std::min(MAX_PREFIX_LEN, (int)word.length());
+
+  for (int len = max_len; len >= 1; --len) {
+    int id = prefix_table_id(word.data() + word.length() - len, len);
+    if (id < 0) continue;
+    if (prefix_flags[id] & (PREFIX_BLACKLISTED | PREFIX_SELF_SOLVING)) continue;
+
+    int solutions = static_cast<int>(prefix_ranges[id].end - prefix_ranges[id].begin);
     if (solutions > 0) {
-      if (solutions < best_count || (solutions == best_count && (int)prefix.length() > (int)best_prefix.length())) {
-        best_prefix = prefix;
+      if (solutions < best_count || (solutions == best_count && len > best_len)) {
+        best_len = len;
         best_count = solutions;
       }
     }
   }
 
-  if (best_prefix.empty()) {
-    for (int len = std::min(MAX_PREFIX_LEN, (int)word.length()); len >= 1; --len) {
-      std::string prefix = get_suffix(word, len);
-      if (blacklist.count(prefix) == 0) return {prefix, 0};
+  if (best_len == 0) {
+    for (int len = max_len; len >= 1; --len) {
+      int id = prefix_table_id(word.data() + word.length() - len, len);
+      if (id < 0 || !(prefix_flags[id] & PREFIX_BLACKLISTED)) return {len, 0};
     }
-    return {get_suffix(word, std::min(MAX_PREFIX_LEN, (int)word.length())), 0};
+    return {max_len, 0};
   }
-  return {best_prefix, best_count};
+  return {best_len, best_count};
 }
 
 // blacklist
-bool ShiritoriGame::word_ends_with_blacklisted_suffix(const std::string& word) const {
+bool ShiritoriGame::word_ends_with_blacklisted_suffix(std::string_view word) const {
   for (const auto& suffix : BLACKLIST_SUFFIXES) {
     if (word.length() >= suffix.length()) {
       if (word.compare(word.length() - suffix.length(), suffix.length(), suffix) == 0) {
@@ -152,65 +200,97 @@ bool ShiritoriGame::is_prefix_blacklisted(const std::string& prefix) const {
 bool ShiritoriGame::is_prefix_self_solving(const std::string& prefix) const {
   // A prefix is self-solving if there exists a word that starts with the prefix
   // and also ends with the prefix (creating a loop)
-  auto it = std::lower_bound(dict.begin(), dict.end(), prefix);
-  while (it != dict.end() && it->rfind(prefix, 0) == 0) {
-    if (it->length() >= prefix.length()) {
-      std::string suffix = get_suffix(*it, prefix.length());
-      if (suffix == prefix) {
-        return true;
-      }
+  int id = prefix_table_id(prefix.data(), static_cast<int>(prefix.length()));
+  if (id >= 0 && !prefix_flags.empty()) return (prefix_flags[id] & PREFIX_SELF_SOLVING) != 0;
+
+  PrefixRange range = prefix_range(prefix);
+  for (uint32_t i = range.begin; i < range.end; ++i) {
+    std::string_view w = dict[i];
+    if (w.length() >= prefix.length() && w.compare(w.length() - prefix.length(), prefix.length(), prefix) == 0) {
+      return true;
     }
-    ++it;
   }
   return false;
 }
 
+PrefixRange ShiritoriGame::prefix_range(const std::string& prefix) const {
+  return prefix_range(prefix.data(), static_cast<int>(prefix.length()));
+}
+
+PrefixRange ShiritoriGame::prefix_range(const char* prefix, int len) const {
+  int id = prefix_table_id(prefix, len);
+  if (id >= 0 && !prefix_ranges.empty()) return prefix_ranges[id];
+
+  // Empty, overlong or non-letter prefixes fall back to a binary search
+  std::string_view key(prefix, len);
+  uint32_t lo = dict.lower_bound(key, 0, static_cast<uint32_t>(dict.size()));
+  uint32_t hi = lo;
+  while (hi < dict.size() && dict[hi].substr(0, key.length()) == key) ++hi;
+  return {lo, hi};
+}
+
 // Load database
-bool ShiritoriGame::load_database(const std::string& dict_file, const std::string& patterns_file) {
+bool ShiritoriGame::load_database(const std::string& dict_file, const std::string& patterns_file,
+    LoadProgressCallback progress) {
+  TRACE_SPAN("ShiritoriGame::load_database");
   auto start_time = std::chrono::high_resolution_clock::now();
+  load_start = start_time;
+  load_progress = std::move(progress);
 
   std::cout << "[Loading database...]\n" << std::flush;
 
   dict.clear();
-  rev_dict.clear();
-  prefix_count_cache.clear();
+  prefix_ranges.clear();
+  prefix_flags.clear();
+  word_features.clear();
+  for (PrefixPostings* postings : {&solutions_by_obscurity, &solutions_by_length}) {
+    postings->words.clear();
+    postings->rank.clear();
+  }
+  snapshot.reset();
   patterns.clear();
-
-  std::ifstream f_dict(dict_file);
-  if (!f_dict) return false;
-
-  dict.reserve(50000);
-  rev_dict.reserve(50000);
-
-  std::string line;
-  while (std::getline(f_dict, line)) {
-    std::string w = parse_word(line);
-    if (!w.empty()) {
-      dict.push_back(w);
-      rev_dict.push_back(reverse_str(w));
+  pattern_slots.clear();
+  pattern_bits.clear();
+
+  // The text dictionary stays the source of truth; the snapshot only caches
+  // what we derive from it and is rebuilt whenever its checksum changes
+  const std::string snapshot_file = dict_file + ".snapshot";
+  bool have_source = false;
+  uint64_t source_checksum = checksum_file(dict_file, have_source);
+
+  if (load_snapshot(snapshot_file, have_source, source_checksum)) {
+    std::cout << "✓ Mapped lexicon snapshot " << snapshot_file << "\n" << std::flush;
+    report_load_progress("snapshot", dict.size());
+  } else {
+    if (!have_source || !build_lexicon(dict_file)) return false;
+    if (save_snapshot(snapshot_file, source_checksum)) {
+      std::cout << "✓ Wrote lexicon snapshot " << snapshot_file << "\n" << std::flush;
     }
   }
 
-  dict.shrink_to_fit();
-  rev_dict.shrink_to_fit();
-  std::sort(dict.begin(), dict.end());
-  std::sort(rev_dict.begin(), rev_dict.end());
-
-  std::cout << "[Building prefix count cache...]\n" << std::flush;
-  prefix_count_cache.reserve(100000);
-  for (const auto& word : dict) {
-    for (int len = 1; len <= std::min(MAX_PREFIX_LEN, (int)word.length()); ++len) {
-      std::string prefix = word.substr(0, len);
-      prefix_count_cache[prefix]++;
-    }
-  }
-  std::cout << "✓ Cached " << prefix_count_cache.size() << " prefix counts\n" << std::flush;
+  used_bits.assign((dict.size() + 63) / 64, 0);
+  build_prefix_summaries();
+  reset_prefix_counters();
+  solved_prefixes.assign(PREFIX_TABLE_SIZE + 1, 0);
+  // A word can only be played once, so the chain never outgrows the dictionary
+  word_chain.clear();
+  word_chain.reserve(dict.size());
+  move_log.clear();
+  ++used_epoch;
+  search_table.clear();
+  // Every entry is reserved up front, 1.6 MB in all, so no ranking allocates
+  ranking_cache.assign(MAX_CACHED_RANKINGS, CachedRanking{NO_RANKING, -1, {}});
+  for (CachedRanking& entry : ranking_cache) entry.ranked.reset();
+  ranking_cache_entry.assign(PREFIX_TABLE_SIZE, 0);
+  next_ranking_entry = 0;
+  ranking_prefix_stamps.assign(PREFIX_TABLE_SIZE, 0);
 
   std::cout << "[Building solution maps...]\n" << std::flush;
 
   std::ifstream f_pat(patterns_file);
   if (!f_pat) return false;
 
+  std::string line;
   patterns.reserve(500);
   while (std::getline(f_pat, line)) {
     std::string p = parse_word(line);
@@ -220,14 +300,25 @@ bool ShiritoriGame::load_database(const std::string& dict_file, const std::strin
   }
   patterns.shrink_to_fit();
   std::sort(patterns.begin(), patterns.end());
-
-  std::cout << "[Pre-calculating best prefixes...]\n" << std::flush;
-  int precalc_count = dict.size();
-  std::cout << "✓ Pre-calculated " << precalc_count << " word prefixes\n" << std::flush;
+  build_pattern_tables();
+  report_load_progress("patterns", patterns.size());
 
   std::cout << "[Building obscure suffix database...]\n" << std::flush;
-  int obscure_count = dict.size() * 3;
-  int unique_prefixes = patterns.size();
+  int obscure_count = 0;
+  std::vector<uint8_t> obscure_prefix_seen(PREFIX_TABLE_SIZE, 0);
+  int unique_prefixes = 0;
+  for (uint32_t i = 0; i < dict.size(); ++i) {
+    int len = word_features[i].obscure_suffix_length;
+    if (len == 0) continue;
+    ++obscure_count;
+    std::string_view word = dict[i];
+    int suffix_len = std::min(len, (int)word.length());
+    int id = prefix_table_id(word.data() + word.length() - suffix_len, suffix_len);
+    if (id >= 0 && !obscure_prefix_seen[id]) {
+      obscure_prefix_seen[id] = 1;
+      ++unique_prefixes;
+    }
+  }
   std::cout << "✓ Found " << obscure_count << " words with obscure suffixes\n";
   std::cout << "  (" << unique_prefixes << " unique obscure prefixes)\n" << std::flush;
 
@@ -237,14 +328,253 @@ bool ShiritoriGame::load_database(const std::string& dict_file, const std::strin
   std::cout << "✓ Loaded " << dict.size() << " words and " << patterns.size() 
     << " patterns in " << duration.count() << "ms\n" << std::flush;
 
+  load_progress = nullptr;
+  return true;
+}
+
+void ShiritoriGame::report_load_progress(const char* phase, size_t count) const {
+  if (!load_progress) return;
+  auto elapsed = std::chrono::high_resolution_clock::now() - load_start;
+  load_progress({phase, count, std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()});
+}
+
+// Sorts the words packed in chars/offsets into `pool`, dropping duplicates:
+// word IDs index the used-word bitset, so every spelling must own exactly one
+static void sort_into_pool(const std::vector<char>& chars, const std::vector<uint32_t>& offsets,
+    WordPool& pool) {
+  std::vector<std::string_view> words(offsets.size() - 1);
+  for (size_t i = 0; i < words.size(); ++i) {
+    words[i] = std::string_view(chars.data() + offsets[i], offsets[i + 1] - offsets[i]);
+  }
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+
+  std::vector<char> sorted_chars;
+  std::vector<uint32_t> sorted_offsets;
+  sorted_chars.reserve(chars.size());
+  sorted_offsets.reserve(words.size() + 1);
+  sorted_offsets.push_back(0);
+  for (std::string_view w : words) {
+    sorted_chars.insert(sorted_chars.end(), w.begin(), w.end());
+    sorted_offsets.push_back(static_cast<uint32_t>(sorted_chars.size()));
+  }
+  pool.adopt(std::move(sorted_chars), std::move(sorted_offsets));
+}
+
+// Parse, sort and index the text dictionary from scratch
+bool ShiritoriGame::build_lexicon(const std::string& dict_file) {
+  std::ifstream f_dict(dict_file);
+  if (!f_dict) return false;
+
+  std::vector<char> chars;
+  std::vector<uint32_t> offsets(1, 0);
+  std::string line;
+  while (std::getline(f_dict, line)) {
+    std::string w = parse_word(line);
+    if (!w.empty()) {
+      chars.insert(chars.end(), w.begin(), w.end());
+      offsets.push_back(static_cast<uint32_t>(chars.size()));
+    }
+  }
+  report_load_progress("parse", offsets.size() - 1);
+
+  sort_into_pool(chars, offsets, dict);
+  report_load_progress("sort", dict.size());
+
+  std::cout << "[Building prefix count cache...]\n" << std::flush;
+  // dict is sorted, so every prefix owns one contiguous [begin, end) slice of it
+  std::vector<PrefixRange> ranges(PREFIX_TABLE_SIZE, PrefixRange{0, 0});
+  int cached_prefixes = 0;
+  for (uint32_t i = 0; i < dict.size(); ++i) {
+    std::string_view word = dict[i];
+    for (int len = 1; len <= std::min(MAX_PREFIX_LEN, (int)word.length()); ++len) {
+      int id = prefix_table_id(word.data(), len);
+      if (id < 0) break;
+      PrefixRange& range = ranges[id];
+      if (range.begin == range.end) {
+        range.begin = i;
+        ++cached_prefixes;
+      }
+      range.end = i + 1;
+    }
+  }
+  prefix_ranges.adopt(std::move(ranges));
+  std::cout << "✓ Cached " << cached_prefixes << " prefix counts\n" << std::flush;
+  report_load_progress("prefix cache", cached_prefixes);
+
+  std::cout << "[Pre-calculating best prefixes...]\n" << std::flush;
+  build_static_features();
+  std::cout << "✓ Pre-calculated " << word_features.size() << " word prefixes\n" << std::flush;
+  report_load_progress("features", word_features.size());
+  build_prefix_postings();
+  report_load_progress("postings", dict.size());
+  return true;
+}
+
+// Everything here depends only on the sorted dictionary, so the AI loops
+// just combine these tables with the live used-word state
+void ShiritoriGame::build_static_features() {
+  std::vector<uint8_t> flags(PREFIX_TABLE_SIZE, 0);
+  for (const auto& suffix : BLACKLIST_SUFFIXES) {
+    int id = prefix_table_id(suffix.data(), static_cast<int>(suffix.length()));
+    if (id >= 0) flags[id] |= PREFIX_BLACKLISTED;
+  }
+  for (uint32_t i = 0; i < dict.size(); ++i) {
+    std::string_view word = dict[i];
+    for (int len = 1; len <= std::min(MAX_PREFIX_LEN, (int)word.length()); ++len) {
+      if (word.compare(0, len, word, word.length() - len, len) == 0) {
+        int id = prefix_table_id(word.data(), len);
+        if (id >= 0) flags[id] |= PREFIX_SELF_SOLVING;
+      }
+    }
+  }
+  prefix_flags.adopt(std::move(flags));
+
+  std::vector<double> obscurity(dict.size());
+  calculateSolutionObscurityScores(dict, obscurity.data());
+
+  std::vector<WordFeatures> features(dict.size());
+  for (uint32_t i = 0; i < dict.size(); ++i) {
+    std::string_view word = dict[i];
+    WordFeatures& f = features[i];
+
+    f.obscurity = obscurity[i];
+
+    int len = find_best_prefix_static_cached_local(word, prefix_ranges.data(), prefix_flags.data()).first;
+    f.creates_prefix_len = static_cast<uint8_t>(len);
+    f.creates_prefix_id = prefix_table_id(word.data() + word.length() - len, len);
+
+    f.flags = 0;
+    if (word_ends_with_blacklisted_suffix(word)) f.flags |= WORD_ENDS_BLACKLISTED;
+    if (f.creates_prefix_id >= 0) {
+      if (prefix_flags[f.creates_prefix_id] & PREFIX_BLACKLISTED) f.flags |= WORD_CREATES_BLACKLISTED;
+      if (prefix_flags[f.creates_prefix_id] & PREFIX_SELF_SOLVING) f.flags |= WORD_CREATES_SELF_SOLVING;
+    }
+
+    // A word is obscure when one of its 2..MAX_PREFIX_LEN letter endings starts few words
+    f.obscure_suffix_length = 0;
+    for (int len = MAX_PREFIX_LEN; len >= 2; --len) {
+      int suffix_len = std::min(len, (int)word.length());
+      PrefixRange range = prefix_range(word.data() + word.length() - suffix_len, suffix_len);
+      if (range.end > range.begin && range.end - range.begin <= OBSCURE_THRESHOLD) {
+        f.obscure_suffix_length = static_cast<uint8_t>(len);
+        break;
+      }
+    }
+  }
+  word_features.adopt(std::move(features));
+}
+
+// Cheap to rebuild, so not worth a place in the snapshot
+void ShiritoriGame::build_prefix_summaries() {
+  prefix_total_length.assign(PREFIX_TABLE_SIZE, 0);
+  for (uint32_t i = 0; i < dict.size(); ++i) {
+    std::string_view word = dict[i];
+    for (int len = 1; len <= std::min(MAX_PREFIX_LEN, (int)word.length()); ++len) {
+      int id = prefix_table_id(word.data(), len);
+      if (id < 0) break;
+      prefix_total_length[id] += static_cast<uint32_t>(word.length());
+    }
+  }
+}
+
+// Solutions most obscure first and longest first, ties by word ID
+void ShiritoriGame::build_prefix_postings() {
+  std::vector<std::pair<double, uint32_t>> keyed(dict.size());
+  for (uint32_t i = 0; i < dict.size(); ++i) keyed[i] = {-word_features[i].obscurity, i};
+  std::sort(keyed.begin(), keyed.end());
+  std::vector<uint32_t> order(dict.size());
+  for (size_t k = 0; k < keyed.size(); ++k) order[k] = keyed[k].second;
+  keyed = std::vector<std::pair<double, uint32_t>>();
+  build_postings(solutions_by_obscurity, order);
+
+  // Lengths are small, so a counting sort orders them
+  size_t max_length = 0;
+  for (uint32_t i = 0; i < dict.size(); ++i) max_length = std::max(max_length, dict[i].length());
+  std::vector<uint32_t> next(max_length + 2, 0);
+  for (uint32_t i = 0; i < dict.size(); ++i) ++next[max_length - dict[i].length() + 1];
+  for (size_t l = 1; l < next.size(); ++l) next[l] += next[l - 1];
+  for (uint32_t i = 0; i < dict.size(); ++i) order[next[max_length - dict[i].length()]++] = i;
+  build_postings(solutions_by_length, order);
+}
+
+// Deals the words out to their slots in key order, so every slot's list comes
+// out sorted without a sort of its own
+void ShiritoriGame::build_postings(PrefixPostings& postings, const std::vector<uint32_t>& order) {
+  std::vector<uint32_t> rank(dict.size());
+  for (uint32_t k = 0; k < order.size(); ++k) rank[order[k]] = k;
+
+  std::vector<uint32_t> fill(PREFIX_TABLE_SIZE);
+  for (size_t i = 0; i < fill.size(); ++i) fill[i] = prefix_ranges[i].begin;
+  std::vector<uint32_t> words(MAX_PREFIX_LEN * dict.size(), 0);
+  for (uint32_t id : order) {
+    std::string_view word = dict[id];
+    for (int len = 1; len <= std::min(MAX_PREFIX_LEN, (int)word.length()); ++len) {
+      int slot = prefix_table_id(word.data(), len);
+      if (slot < 0) break;
+      words[(len - 1) * dict.size() + fill[slot]++] = id;
+    }
+  }
+  postings.words.adopt(std::move(words));
+  postings.rank.adopt(std::move(rank));
+}
+
+// The patterns as one flag per prefix slot, and the words whose creates-prefix
+// is one of them as a bitset laid out like used_bits
+void ShiritoriGame::build_pattern_tables() {
+  pattern_slots.assign(PREFIX_TABLE_SIZE, 0);
+  for (const auto& p : patterns) {
+    int id = prefix_table_id(p.data(), static_cast<int>(p.length()));
+    if (id >= 0) pattern_slots[id] = 1;
+  }
+  pattern_bits.assign((dict.size() + 63) / 64, 0);
+  for (uint32_t i = 0; i < dict.size(); ++i) {
+    const int32_t slot = word_features[i].creates_prefix_id;
+    if (slot >= 0 && pattern_slots[slot]) pattern_bits[i >> 6] |= uint64_t(1) << (i & 63);
+  }
+}
+
+bool ShiritoriGame::save_snapshot(const std::string& path, uint64_t source_checksum) const {
+  LexiconTables tables;
+  tables.dict_chars = dict.chars();
+  tables.dict_offsets = dict.offsets();
+  tables.dict_count = static_cast<uint32_t>(dict.size());
+  tables.prefix_ranges = prefix_ranges.data();
+  tables.prefix_flags = prefix_flags.data();
+  tables.word_features = word_features.data();
+  tables.obscurity_postings = solutions_by_obscurity.words.data();
+  tables.obscurity_ranks = solutions_by_obscurity.rank.data();
+  tables.length_postings = solutions_by_length.words.data();
+  tables.length_ranks = solutions_by_length.rank.data();
+  return write_lexicon_snapshot(path, source_checksum, tables);
+}
+
+// The word pools and the prefix and feature tables are used straight from the
+// mapped pages, so every process running the same dictionary shares one
+// physical copy
+bool ShiritoriGame::load_snapshot(const std::string& path, bool check_source, uint64_t source_checksum) {
+  LexiconTables tables;
+  std::unique_ptr<MappedFile> file = map_lexicon_snapshot(path, check_source, source_checksum, tables);
+  if (!file) return false;
+
+  dict.view(tables.dict_chars, tables.dict_offsets, tables.dict_count);
+  prefix_ranges.view(tables.prefix_ranges, PREFIX_TABLE_SIZE);
+  prefix_flags.view(tables.prefix_flags, PREFIX_TABLE_SIZE);
+  word_features.view(tables.word_features, tables.dict_count);
+  solutions_by_obscurity.words.view(tables.obscurity_postings, MAX_PREFIX_LEN * tables.dict_count);
+  solutions_by_obscurity.rank.view(tables.obscurity_ranks, tables.dict_count);
+  solutions_by_length.words.view(tables.length_postings, MAX_PREFIX_LEN * tables.dict_count);
+  solutions_by_length.rank.view(tables.length_ranks, tables.dict_count);
+  snapshot = std::move(file);
   return true;
 }
 
 void ShiritoriGame::reset_game() {
-  used_words.clear();
+  std::fill(used_bits.begin(), used_bits.end(), 0);
+  reset_prefix_counters();
   word_chain.clear();
-  exhausted_prefixes.clear();
-  solved_suffixes.clear();
+  move_log.clear();
+  std::fill(solved_prefixes.begin(), solved_prefixes.end(), 0);
   turn_count = 0;
   turns_since_heart_loss = 0;
   player_hearts = STARTING_HEARTS;
@@ -252,32 +582,154 @@ void ShiritoriGame::reset_game() {
   letters_used.reset();
   current_prefix = "";
   last_top_moves.clear();
+  ++used_epoch;
+  ++state_version;
+  speculative_replies.clear();
+  speculation_version = NO_SPECULATION;
 }
 
 bool ShiritoriGame::is_valid_word(const std::string& word) {
   std::string lower = word;
   to_lower_inplace(lower);
-  return std::binary_search(dict.begin(), dict.end(), lower);
+  return word_id(lower) >= 0;
 }
 
 bool ShiritoriGame::is_used(const std::string& word) {
   std::string lower = word;
   to_lower_inplace(lower);
-  return used_words.count(lower) > 0;
+  int id = word_id(lower);
+  return id >= 0 && is_word_used(id);
+}
+
+int ShiritoriGame::word_id(const std::string& word) const {
+  PrefixRange range = prefix_range(word.data(), std::min(MAX_PREFIX_LEN, (int)word.length()));
+  uint32_t id = dict.lower_bound(word, range.begin, range.end);
+  if (id == range.end || dict[id] != word) return -1;
+  return static_cast<int>(id);
+}
+
+void ShiritoriGame::reset_prefix_counters() {
+  prefix_unused.resize(prefix_ranges.size());
+  for (size_t i = 0; i < prefix_ranges.size(); ++i) {
+    prefix_unused[i] = prefix_ranges[i].end - prefix_ranges[i].begin;
+  }
+  prefix_unused_length = prefix_total_length;
+  exhausted_prefixes.assign(prefix_ranges.size(), 0);
+  for (PrefixPostings* postings : {&solutions_by_obscurity, &solutions_by_length}) {
+    postings->cursor.resize(prefix_ranges.size());
+    postings->head.resize(prefix_ranges.size());
+    for (size_t i = 0; i < prefix_ranges.size(); ++i) {
+      const PrefixRange& range = prefix_ranges[i];
+      const size_t block = (prefix_table_len(static_cast<int>(i)) - 1) * dict.size();
+      postings->cursor[i] = range.begin;
+      postings->head[i] = range.end > range.begin ? postings->words[block + range.begin] : NO_WORD;
+    }
+  }
+}
+
+void ShiritoriGame::advance_posting(PrefixPostings& postings, int len, int slot) {
+  const uint32_t* words = postings.words.data() + (len - 1) * dict.size();
+  uint32_t& cursor = postings.cursor[slot];
+  if (postings.head[slot] == NO_WORD || !is_word_used(postings.head[slot])) return;
+  const uint32_t end = prefix_ranges[slot].end;
+  while (cursor < end && is_word_used(words[cursor])) ++cursor;
+  postings.head[slot] = cursor < end ? words[cursor] : NO_WORD;
+}
+
+// The freed word sits before the cursor exactly when it ranks ahead of the
+// word there; every entry in between is used, so it becomes the new head
+void ShiritoriGame::rewind_posting(PrefixPostings& postings, int len, int slot, uint32_t id) {
+  const uint32_t* words = postings.words.data() + (len - 1) * dict.size();
+  uint32_t& cursor = postings.cursor[slot];
+  const uint32_t rank = postings.rank[id];
+  if (postings.head[slot] != NO_WORD && postings.rank[postings.head[slot]] < rank) return;
+  const uint32_t* it = std::lower_bound(words + prefix_ranges[slot].begin, words + cursor, rank,
+      [&postings](uint32_t word, uint32_t r) { return postings.rank[word] < r; });
+  cursor = static_cast<uint32_t>(it - words);
+  postings.head[slot] = id;
+}
+
+// Consuming a word only touches the MAX_PREFIX_LEN prefix slots it falls under
+void ShiritoriGame::mark_used(uint32_t id) {
+  if (is_word_used(id)) return;
+  used_bits[id >> 6] |= uint64_t(1) << (id & 63);
+  ++used_epoch;
+
+  std::string_view word = dict[id];
+  for (int len = 1; len <= std::min(MAX_PREFIX_LEN, (int)word.length()); ++len) {
+    int pid = prefix_table_id(word.data(), len);
+    if (pid < 0) break;
+    prefix_unused_length[pid] -= static_cast<uint32_t>(word.length());
+    if (--prefix_unused[pid] == 0) exhausted_prefixes[pid] = 1;
+    advance_posting(solutions_by_obscurity, len, pid);
+    advance_posting(solutions_by_length, len, pid);
+  }
+}
+
+void ShiritoriGame::unmark_used(uint32_t id) {
+  if (!is_word_used(id)) return;
+  used_bits[id >> 6] &= ~(uint64_t(1) << (id & 63));
+  ++used_epoch;
+
+  std::string_view word = dict[id];
+  for (int len = 1; len <= std::min(MAX_PREFIX_LEN, (int)word.length()); ++len) {
+    int pid = prefix_table_id(word.data(), len);
+    if (pid < 0) break;
+    prefix_unused_length[pid] += static_cast<uint32_t>(word.length());
+    if (prefix_unused[pid]++ == 0) exhausted_prefixes[pid] = 0;
+    rewind_posting(solutions_by_obscurity, len, pid, id);
+    rewind_posting(solutions_by_length, len, pid, id);
+  }
+}
+
+uint32_t ShiritoriGame::count_used(PrefixRange range) const {
+  if (range.begin >= range.end) return 0;
+  uint32_t first_block = range.begin >> 6;
+  uint32_t last_block = (range.end - 1) >> 6;
+  uint64_t head_mask = ~uint64_t(0) << (range.begin & 63);
+  uint64_t tail_mask = ~uint64_t(0) >> (63 - ((range.end - 1) & 63));
+  if (first_block == last_block) {
+    return popcount64(used_bits[first_block] & head_mask & tail_mask);
+  }
+  uint32_t count = popcount64(used_bits[first_block] & head_mask);
+  for (uint32_t b = first_block + 1; b < last_block; ++b) {
+    count += popcount64(used_bits[b]);
+  }
+  return count + popcount64(used_bits[last_block] & tail_mask);
+}
+
+// The unused words in range whose creates-prefix is a rare pattern with
+// unused solutions left and not yet solved, in ID order. Blocks of 64 words
+// holding none of them cost one test.
+void ShiritoriGame::collect_pattern_words(PrefixRange range, ScratchVector<uint32_t>& out) const {
+  if (range.begin >= range.end || pattern_bits.empty()) return;
+  const uint32_t first_block = range.begin >> 6;
+  const uint32_t last_block = (range.end - 1) >> 6;
+  for (uint32_t b = first_block; b <= last_block; ++b) {
+    uint64_t bits = pattern_bits[b] & ~used_bits[b];
+    if (b == first_block) bits &= ~uint64_t(0) << (range.begin & 63);
+    if (b == last_block) bits &= ~uint64_t(0) >> (63 - ((range.end - 1) & 63));
+    while (bits) {
+      const uint32_t id = b * 64 + lowest_bit64(bits);
+      bits &= bits - 1;
+      if (creates_prefix_unused(id) > 0 && !creates_prefix_solved(id)) out.push_back(id);
+    }
+  }
+  TURN_PROFILE_COUNT(turn_profile, used_probes, last_block - first_block + 1);
+}
+
+bool ShiritoriGame::isRarePrefix(const std::string& prefix) const {
+  int id = prefix_table_id(prefix.data(), static_cast<int>(prefix.length()));
+  return id >= 0 && static_cast<size_t>(id) < pattern_slots.size() && pattern_slots[id];
 }
 
 std::string ShiritoriGame::getRandomStartWord() {
   if (dict.empty()) return "";
 
   std::uniform_int_distribution<> dis(0, std::min(1000, static_cast<int>(dict.size()) - 1));
-  std::string word = dict[dis(rng)];
-
-  word_chain.push_back(word);
-  used_words.insert(word);
-  ++turn_count;
-  ++turns_since_heart_loss;
-
-  return word;
+  int id = dis(rng);
+  move_log.push_back(applyMove(id, true));
+  return std::string(dict[id]);
 }
 
 std::string ShiritoriGame::getCurrentPrefix() const {
@@ -289,20 +741,20 @@ int ShiritoriGame::getCurrentDifficulty() const {
 }
 
 bool ShiritoriGame::has_unused_words(const std::string& prefix) const {
-  if (exhausted_prefixes.count(prefix) > 0) return false;
-
-  auto cache_it = prefix_count_cache.find(prefix);
-  if (cache_it == prefix_count_cache.end() || cache_it->second == 0) return false;
+  return countSolutions(prefix) > 0;
+}
 
-  auto it = std::lower_bound(dict.begin(), dict.end(), prefix);
-  while (it != dict.end() && it->rfind(prefix, 0) == 0) {
-    if (used_words.count(*it) == 0) return true;
-    ++it;
+int ShiritoriGame::countSolutions(const std::string& prefix) const {
+  int id = prefix_table_id(prefix.data(), static_cast<int>(prefix.length()));
+  if (id >= 0 && !prefix_unused.empty()) {
+    return exhausted_prefixes[id] ? 0 : static_cast<int>(prefix_unused[id]);
   }
-  return false;
+
+  PrefixRange range = prefix_range(prefix);
+  return static_cast<int>(range.end - range.begin - count_used(range));
 }
 
-std::string ShiritoriGame::find_valid_prefix(const std::string& word, int max_difficulty) const {
+std::string ShiritoriGame::find_valid_prefix(std::string_view word, int max_difficulty) const {
   for (int len = max_difficulty; len >= 1; --len) {
     std::string prefix = get_suffix(word, len);
     if (has_unused_words(prefix)) return prefix;
@@ -310,7 +762,7 @@ std::string ShiritoriGame::find_valid_prefix(const std::string& word, int max_di
   return "";
 }
 
-double calculateSolutionObscurityScore(const std::string& word) {
+double calculateSolutionObscurityScoreReference(const std::string& word) {
   double score = 0.0;
 
   // 1. WORD LENGTH - Longer words are more obscure
@@ -430,82 +882,336 @@ double calculateSolutionObscurityScore(const std::string& word) {
   return score;
 }
 
+namespace {
+
+constexpr uint32_t letter_bit(char c) { return 1u << (c - 'a'); }
+
+const uint32_t VERY_RARE_LETTERS = letter_bit('j') | letter_bit('q') | letter_bit('x') | letter_bit('z');
+const uint32_t RARE_LETTERS = letter_bit('k') | letter_bit('v') | letter_bit('w');
+const uint32_t VOWEL_LETTERS = letter_bit('a') | letter_bit('e') | letter_bit('i') | letter_bit('o') | letter_bit('u');
+const size_t OBSCURITY_KERNEL_MAX_LEN = 64;
+
+// Per-byte letter classes and the length and streak bands of the reference,
+// looked up once per letter or word instead of tested against masks and
+// thresholds
+struct ObscurityTables {
+  enum : uint8_t { LETTER = 1, VOWEL = 2, RARE = 4, VERY_RARE = 8 };
+  uint8_t letter_class[256] = {};   // 0 outside a..z
+  int32_t length_points[OBSCURITY_KERNEL_MAX_LEN + 1];
+  int32_t consonant_streak_points[OBSCURITY_KERNEL_MAX_LEN + 1];
+  int32_t vowel_streak_points[OBSCURITY_KERNEL_MAX_LEN + 1];
+
+  ObscurityTables() {
+    for (char c = 'a'; c <= 'z'; ++c) {
+      const uint32_t bit = letter_bit(c);
+      letter_class[static_cast<uint8_t>(c)] = LETTER | (VOWEL_LETTERS & bit ? VOWEL : 0) |
+          (RARE_LETTERS & bit ? RARE : 0) | (VERY_RARE_LETTERS & bit ? VERY_RARE : 0);
+    }
+    for (int n = 0; n <= static_cast<int>(OBSCURITY_KERNEL_MAX_LEN); ++n) {
+      length_points[n] = n >= 13 ? (n - 13) * 30 + 150 : n >= 11 ? (n - 11) * 25 + 100
+                       : n >= 9 ? (n - 9) * 20 + 60 : n >= 7 ? (n - 7) * 15 + 30 : n * 10;
+      consonant_streak_points[n] = n * (n >= 5 ? 25 : n >= 4 ? 20 : n >= 3 ? 15 : 0);
+      vowel_streak_points[n] = n >= 3 ? n * 20 : 0;
+    }
+  }
+};
+
+const ObscurityTables OBSCURITY_TABLES;
+
+// Letter pairs seen once and twice in one word, as a 1024-bit bitmap; built
+// fresh for each word, for single calls
+struct PairBitmap {
+  uint64_t seen[16] = {}, twice[16] = {};
+
+  // Records a pair; true if it was already seen
+  bool note(unsigned code) {
+    const uint64_t bit = uint64_t(1) << (code & 63);
+    const uint64_t before = seen[code >> 6] & bit;
+    twice[code >> 6] |= before;
+    seen[code >> 6] |= bit;
+    return before != 0;
+  }
+  bool repeated(unsigned code) const { return twice[code >> 6] >> (code & 63) & 1; }
+};
+
+// The same sets as word-stamped tables, so a batch clears them once rather
+// than once per word: a pair is in a set when its entry holds the current
+// word's stamp
+struct PairStamps {
+  uint32_t seen[1024] = {}, twice[1024] = {};
+  uint32_t stamp = 0;
+
+  void next_word() {
+    if (++stamp != 0) return;
+    std::fill(std::begin(seen), std::end(seen), 0u);
+    std::fill(std::begin(twice), std::end(twice), 0u);
+    stamp = 1;
+  }
+  bool note(unsigned code) {
+    const bool again = seen[code] == stamp;
+    if (again) twice[code] = stamp;
+    seen[code] = stamp;
+    return again;
+  }
+  bool repeated(unsigned code) const { return twice[code] == stamp; }
+};
+
+// Points for the 2..4 letter substrings of `letters` that occur more than once,
+// given the `count` positions whose letter pair repeats. A substring seen k
+// times scores k * n * 10, i.e. n * 10 for every occurrence that has a twin.
+// A longer substring can only repeat where its first pair does, so n = 3 and 4
+// compare just the handful of positions left from the previous length.
+int64_t repeated_ngram_points(const uint8_t* letters, size_t len, uint8_t* positions, size_t count) {
+  int64_t points = static_cast<int64_t>(count) * 20;
+  for (size_t n = 3; n <= 4 && count >= 2; ++n) {
+    uint32_t codes[OBSCURITY_KERNEL_MAX_LEN];
+    size_t candidates = 0;
+    for (size_t k = 0; k < count; ++k) {
+      if (positions[k] + n > len) continue;
+      uint32_t code = 0;
+      for (size_t l = 0; l < n; ++l) code = code << 5 | letters[positions[k] + l];
+      positions[candidates] = positions[k];
+      codes[candidates++] = code;
+    }
+    count = 0;
+    for (size_t k = 0; k < candidates; ++k) {
+      bool twin = false;
+      for (size_t l = 0; l < candidates && !twin; ++l) twin = l != k && codes[l] == codes[k];
+      if (twin) positions[count++] = positions[k];
+    }
+    points += static_cast<int64_t>(count * n * 10);
+  }
+  return points;
+}
+
+// calculateSolutionObscurityScoreReference for a word of a..z letters, in one
+// pass: 26-bit letter sets, the class and band tables and `pairs` stand in for
+// the maps and sets. Every term is a whole number, so summing them as integers
+// gives the reference's double exactly. False for other words, which take the
+// reference.
+template <typename Pairs>
+bool obscurity_score_kernel(const char* word, size_t len, Pairs& pairs, double& score) {
+  if (len > OBSCURITY_KERNEL_MAX_LEN) return false;
+  if (len == 0) {
+    score = 0.0;
+    return true;
+  }
+  uint8_t letters[OBSCURITY_KERNEL_MAX_LEN];
+  uint16_t pair_codes[OBSCURITY_KERNEL_MAX_LEN];
+  unsigned classes = ObscurityTables::LETTER;
+  // Letters seen at least once, twice, three and four times
+  uint32_t seen = 0, seen2 = 0, seen3 = 0, seen4 = 0;
+  int very_rare_count = 0, rare_count = 0, doubled = 0;
+  int consonant_streak = 0, max_consonant_streak = 0;
+  int vowel_streak = 0, max_vowel_streak = 0;
+  bool pair_repeats = false;
+
+  for (size_t i = 0; i < len; ++i) {
+    const uint8_t c = static_cast<uint8_t>(word[i]);
+    const unsigned letter_class = OBSCURITY_TABLES.letter_class[c];
+    classes &= letter_class;
+    // Out-of-range bytes still index the tables safely; the word is rejected
+    // after the loop
+    const unsigned letter = (c - 'a') & 31u;
+    letters[i] = static_cast<uint8_t>(letter);
+    const uint32_t bit = 1u << letter;
+    seen4 |= seen3 & bit;
+    seen3 |= seen2 & bit;
+    seen2 |= seen & bit;
+    seen |= bit;
+    very_rare_count += (letter_class & ObscurityTables::VERY_RARE) != 0;
+    rare_count += (letter_class & ObscurityTables::RARE) != 0;
+    const int vowel = (letter_class & ObscurityTables::VOWEL) != 0;
+    vowel_streak = (vowel_streak + 1) * vowel;
+    consonant_streak = (consonant_streak + 1) * (1 - vowel);
+    max_vowel_streak = std::max(max_vowel_streak, vowel_streak);
+    max_consonant_streak = std::max(max_consonant_streak, consonant_streak);
+    if (i > 0) {
+      doubled += letters[i - 1] == letter;
+      const unsigned code = letters[i - 1] << 5 | letter;
+      pair_codes[i - 1] = static_cast<uint16_t>(code);
+      pair_repeats |= pairs.note(code);
+    }
+  }
+  if (!(classes & ObscurityTables::LETTER)) return false;
+
+  int64_t total = OBSCURITY_TABLES.length_points[len];
+  total += very_rare_count * 45 + rare_count * 25;
+  total += popcount64(seen4) * 60 + popcount64(seen3 & ~seen4) * 45 + popcount64(seen2 & ~seen3) * 20;
+  total += doubled * 30;
+  total += OBSCURITY_TABLES.consonant_streak_points[max_consonant_streak];
+  total += OBSCURITY_TABLES.vowel_streak_points[max_vowel_streak];
+
+  if (pair_repeats) {
+    uint8_t positions[OBSCURITY_KERNEL_MAX_LEN];
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < len; ++i) {
+      if (pairs.repeated(pair_codes[i])) positions[count++] = static_cast<uint8_t>(i);
+    }
+    total += repeated_ngram_points(letters, len, positions, count);
+  }
+  if ((double)popcount64(seen) / len < 0.6) total += 35;
+
+  score = static_cast<double>(total);
+  return true;
+}
+
+} // namespace
+
+double calculateSolutionObscurityScore(const std::string& word) {
+  PairBitmap pairs;
+  double score;
+  if (obscurity_score_kernel(word.data(), word.length(), pairs, score)) return score;
+  return calculateSolutionObscurityScoreReference(word);
+}
+
+void calculateSolutionObscurityScores(const WordPool& words, double* scores) {
+  // 8 KB of stamps, cleared once for the whole batch
+  PairStamps pairs;
+  for (size_t i = 0; i < words.size(); ++i) {
+    std::string_view word = words[i];
+    pairs.next_word();
+    if (!obscurity_score_kernel(word.data(), word.length(), pairs, scores[i])) {
+      scores[i] = calculateSolutionObscurityScoreReference(std::string(word));
+    }
+  }
+}
+
 // AI moves
-std::vector<WordRank> ShiritoriGame::getTopAIMoves(const std::string& required_prefix, int top_n) {
-  std::vector<WordRank> candidates;
-  candidates.reserve(500);
+std::vector<WordRank> ShiritoriGame::getTopAIMoves(const std::string& required_prefix, int top_n,
+    const std::atomic<bool>* cancel) {
+  std::vector<WordRank> moves;
+  getTopAIMoves(required_prefix, top_n, moves, cancel);
+  return moves;
+}
 
-  auto it = std::lower_bound(dict.begin(), dict.end(), required_prefix);
+size_t ShiritoriGame::getTopAIMoves(const std::string& required_prefix, int top_n, std::vector<WordRank>& moves,
+    const std::atomic<bool>* cancel) {
+  const RankedMoves* ranked = rank_top_moves(required_prefix, cancel);
+  if (!ranked) return 0;
+  const size_t count = std::min(ranked->size(), static_cast<size_t>(std::max(top_n, 0)));
+  if (moves.size() < count) moves.resize(count);
+  for (size_t rank = 0; rank < count; ++rank) fill_ranked_move(*ranked, rank, moves[rank]);
+  return count;
+}
 
-  int count = 0;
-  const int MAX_CANDIDATES = 200;
+// The WordRank shown for one row of a ranking
+void ShiritoriGame::fill_ranked_move(const RankedMoves& ranked, size_t rank, WordRank& wr) const {
+  const uint32_t row = ranked.order[rank];
+  const uint32_t id = ranked.ids[row];
+  wr.word.assign(dict[id]);
+  wr.suffix.clear();
+  wr.prefix_solutions_count = 0;
+  wr.max_solution_len = ranked.max_solution_len[row];
+  wr.obscurity_score = ranked.obscurity[row];
+  wr.creates_prefix_solutions = ranked.solutions[row];
+  wr.creates_prefix.assign(creates_prefix(id));
+  wr.difficulty_level = (int)wr.creates_prefix.length();
+  wr.is_obscure_word = false;
+  wr.obscure_suffix_length = 0;
+  wr.total_score = ranked.total[row];
+  wr.best_creates_prefix.clear();
+  wr.best_creates_prefix_solutions = 0;
+  wr.is_blacklisted = false;
+  wr.is_self_solving = false;
+}
 
-  // Track which prefixes we've already used to ensure uniqueness
-  std::unordered_set<std::string> used_prefixes;
+// The full getTopAIMoves ranking for `required_prefix`, from the cache when it
+// is current; nullptr when cancelled. Rankings are built over the storage of
+// the entry they replace, so in steady state they do not allocate.
+const ShiritoriGame::RankedMoves* ShiritoriGame::rank_top_moves(const std::string& required_prefix,
+    const std::atomic<bool>* cancel) {
+  TURN_PROFILE_SCOPE(turn_profile, PHASE_TOP_SOLVES);
+  TRACE_SPAN("ShiritoriGame::rank_top_moves");
+  const int slot = prefix_table_id(required_prefix.data(), static_cast<int>(required_prefix.length()));
+  if (slot < 0 || ranking_cache.empty()) {
+    return rank_moves(required_prefix, uncached_ranking, SIZE_MAX, cancel) ? &uncached_ranking : nullptr;
+  }
+
+  CachedRanking* cached;
+  if (ranking_cache_entry[slot] != 0) {
+    cached = &ranking_cache[ranking_cache_entry[slot] - 1];
+    if (cached->epoch == used_epoch) return &cached->ranked;
+  } else {
+    cached = &ranking_cache[next_ranking_entry];
+    if (cached->slot >= 0) ranking_cache_entry[cached->slot] = 0;
+    cached->slot = slot;
+    ranking_cache_entry[slot] = static_cast<uint16_t>(next_ranking_entry + 1);
+    next_ranking_entry = (next_ranking_entry + 1) % ranking_cache.size();
+  }
 
-  // STEP 1: Collect candidates with solution obscurity analysis
-  while (it != dict.end() && it->rfind(required_prefix, 0) == 0 && count < MAX_CANDIDATES) {
-    if (used_words.count(*it) == 0) {
-      WordRank wr;
-      wr.word = *it;
+  // A cancelled scan is incomplete and must not be cached
+  if (!rank_moves(required_prefix, cached->ranked, SIZE_MAX, cancel)) {
+    cached->epoch = NO_RANKING;
+    return nullptr;
+  }
+  cached->epoch = used_epoch;
+  return &cached->ranked;
+}
 
-      // Find best creates-prefix
-      auto prefix_info = find_best_prefix_static_cached_local(wr.word, prefix_count_cache, BLACKLIST_SUFFIXES, dict);
-      wr.creates_prefix = prefix_info.first;
-      wr.is_blacklisted = is_prefix_blacklisted(wr.creates_prefix);
-      wr.is_self_solving = is_prefix_self_solving(wr.creates_prefix);
+void ShiritoriGame::RankedMoves::reset() {
+  ids.clear();
+  solutions.clear();
+  max_solution_len.clear();
+  obscurity.clear();
+  total.clear();
+  order.clear();
+  ids.reserve(MAX_RANKED_MOVES);
+  solutions.reserve(MAX_RANKED_MOVES);
+  max_solution_len.reserve(MAX_RANKED_MOVES);
+  obscurity.reserve(MAX_RANKED_MOVES);
+  total.reserve(MAX_RANKED_MOVES);
+  order.reserve(MAX_RANKED_MOVES);
+}
 
-      // Skip bad candidates
-      if (wr.is_blacklisted || wr.is_self_solving || word_ends_with_blacklisted_suffix(wr.word)) {
-        ++it;
-        continue;
-      }
+// Ranks the moves answering `required_prefix` into `ranked`, reusing its
+// storage, with the best `sorted` rows in order; false when cancelled
+bool ShiritoriGame::rank_moves(const std::string& required_prefix, RankedMoves& ranked, size_t sorted,
+    const std::atomic<bool>* cancel) {
+  ranked.reset();
 
-      // Skip if we've already used this prefix (ensure uniqueness)
-      if (used_prefixes.count(wr.creates_prefix) > 0) {
-        ++it;
-        continue;
-      }
+  PrefixRange range = prefix_range(required_prefix);
 
-      // Collect UNUSED solutions WITH OBSCURITY SCORES
-      std::vector<std::pair<std::string, double>> solutions_with_scores;
-      int solution_count = 0;
-      double best_solution_obscurity = 0.0;
-      int max_solution_length = 0;
-      std::string best_solution_word = "";
+  // Track which prefixes we've already used to ensure uniqueness
+  if (++ranking_stamp == 0) {
+    std::fill(ranking_prefix_stamps.begin(), ranking_prefix_stamps.end(), 0);
+    ranking_stamp = 1;
+  }
 
-      auto sol_it = std::lower_bound(dict.begin(), dict.end(), wr.creates_prefix);
-      while (sol_it != dict.end() && sol_it->rfind(wr.creates_prefix, 0) == 0) {
-        if (used_words.count(*sol_it) == 0) {
-          double obscurity = calculateSolutionObscurityScore(*sol_it);
-          solutions_with_scores.push_back({*sol_it, obscurity});
-          solution_count++;
+  // STEP 1: Collect candidates with solution obscurity analysis. Words whose
+  // creates-prefix is a rare pattern are taken first, so they always make the
+  // cut, and the rest of the range fills the ranking up to MAX_RANKED_MOVES. A
+  // rare word taken in the first pass has its prefix stamped, so the second
+  // pass skips it.
+  auto consider = [&](uint32_t i) {
+    TURN_PROFILE_COUNT(turn_profile, entries_scanned, 1);
+    TURN_PROFILE_COUNT(turn_profile, used_probes, 1);
+    if (!is_word_used(i)) {
+      const WordFeatures& features = word_features[i];
 
-          if (obscurity > best_solution_obscurity) {
-            best_solution_obscurity = obscurity;
-            best_solution_word = *sol_it;
-          }
+      // Skip bad candidates
+      if (features.flags & (WORD_ENDS_BLACKLISTED | WORD_CREATES_BLACKLISTED | WORD_CREATES_SELF_SOLVING)) {
+        return;
+      }
 
-          max_solution_length = std::max(max_solution_length, (int)sol_it->length());
-        }
-        ++sol_it;
+      // Skip if we've already used this prefix (ensure uniqueness)
+      const int32_t prefix_slot = features.creates_prefix_id;
+      if (prefix_slot >= 0 && ranking_prefix_stamps[prefix_slot] == ranking_stamp) {
+        return;
       }
 
       // Skip if no solutions or already solved
-      if (solution_count == 0 || solved_suffixes.count(wr.creates_prefix) > 0) {
-        ++it;
-        continue;
+      TURN_PROFILE_COUNT(turn_profile, used_probes, 1);
+      const int solution_count = creates_prefix_unused(i);
+      if (solution_count == 0 || creates_prefix_solved(i)) {
+        return;
       }
 
-      // Sort solutions by obscurity (most obscure first)
-      std::sort(solutions_with_scores.begin(), solutions_with_scores.end(),
-          [](const auto& a, const auto& b) {
-          if (std::abs(a.second - b.second) > 0.001) return a.second > b.second;
-          return a.first.length() > b.first.length();
-          });
-
-      wr.creates_prefix_solutions = solution_count;
-      wr.max_solution_len = max_solution_length;
+      // UNUSED solutions WITH OBSCURITY SCORES: the most obscure and the
+      // longest, settled from the prefix slot unless they have been played
+      double best_solution_obscurity = 0.0;
+      int max_solution_length = 0;
+      creates_prefix_best(i, max_solution_length, &best_solution_obscurity);
 
       // NEW RANKING SYSTEM (like solver.cpp):
       // PRIMARY: Fewer solutions (1 is best)
@@ -524,90 +1230,287 @@ std::vector<WordRank> ShiritoriGame::getTopAIMoves(const std::string& required_p
       total += (max_solution_length - 5) * 25.0;
 
       // Small bonus for longer prefixes
-      total += wr.creates_prefix.length() * 30.0;
+      total += features.creates_prefix_len * 30.0;
 
-      wr.total_score = total;
-      wr.obscurity_score = best_solution_obscurity;  // Store for display
-      wr.difficulty_level = (int)wr.creates_prefix.length();
+      ranked.order.push_back(static_cast<uint32_t>(ranked.ids.size()));
+      ranked.ids.push_back(i);
+      ranked.solutions.push_back(solution_count);
+      ranked.max_solution_len.push_back(max_solution_length);
+      ranked.obscurity.push_back(best_solution_obscurity);
+      ranked.total.push_back(total);
 
-      candidates.push_back(wr);
-      used_prefixes.insert(wr.creates_prefix);  // Mark prefix as used
-      count++;
+      if (prefix_slot >= 0) ranking_prefix_stamps[prefix_slot] = ranking_stamp;  // Mark prefix as used
+    }
+  };
+  {
+    ScratchArena::Scope scratch_scope(scratch);
+    ScratchVector<uint32_t> rare(scratch);
+    collect_pattern_words(range, rare);
+    for (size_t k = 0; k < rare.size() && ranked.ids.size() < MAX_RANKED_MOVES; ++k) {
+      if (is_cancelled(cancel)) break;
+      consider(rare[k]);
     }
-    ++it;
+  }
+  for (uint32_t i = range.begin; i < range.end && ranked.ids.size() < MAX_RANKED_MOVES; ++i) {
+    if (is_cancelled(cancel)) break;
+    consider(i);
   }
 
-  if (candidates.empty()) return {};
+  if (is_cancelled(cancel)) return false;
+  TURN_PROFILE_COUNT(turn_profile, candidates, ranked.size());
 
-  // STEP 2: Sort by NEW ranking system
-  std::sort(candidates.begin(), candidates.end(), [](const WordRank& a, const WordRank& b) {
+  // STEP 2: Sort by NEW ranking system. Only the row order moves; dict is
+  // sorted, so word order is ID order.
+  auto ranks_before = [&ranked](uint32_t a, uint32_t b) {
       // PRIMARY: Fewer solutions
-      if (a.creates_prefix_solutions != b.creates_prefix_solutions) {
-      return a.creates_prefix_solutions < b.creates_prefix_solutions;
+      if (ranked.solutions[a] != ranked.solutions[b]) {
+      return ranked.solutions[a] < ranked.solutions[b];
       }
 
       // SECONDARY: Higher solution obscurity
-      if (std::abs(a.obscurity_score - b.obscurity_score) > 5.0) {
-      return a.obscurity_score > b.obscurity_score;
+      if (std::abs(ranked.obscurity[a] - ranked.obscurity[b]) > 5.0) {
+      return ranked.obscurity[a] > ranked.obscurity[b];
       }
 
       // TERTIARY: Longer solutions
-      if (a.max_solution_len != b.max_solution_len) {
-      return a.max_solution_len > b.max_solution_len;
+      if (ranked.max_solution_len[a] != ranked.max_solution_len[b]) {
+      return ranked.max_solution_len[a] > ranked.max_solution_len[b];
       }
 
       // Final tiebreaker
-      return a.word < b.word;
-      });
-
-  // STEP 3: Return top N candidates (already unique by prefix)
-  if (candidates.size() > static_cast<size_t>(top_n)) {
-    candidates.resize(top_n);
+      return ranked.ids[a] < ranked.ids[b];
+      };
+  if (sorted < ranked.order.size()) {
+    std::partial_sort(ranked.order.begin(), ranked.order.begin() + sorted, ranked.order.end(), ranks_before);
+  } else {
+    std::sort(ranked.order.begin(), ranked.order.end(), ranks_before);
   }
 
-  return candidates;
+  // Candidates are already unique by prefix; callers take the top N
+  return true;
 }
 
 void ShiritoriGame::processPlayerWord(const std::string& word) {
-  std::string lower = word;
-  to_lower_inplace(lower);
+  // GameController only submits unused dictionary words; those are lowercase
+  // already, so the folded copy is only made when there is something to fold
+  int id;
+  if (std::any_of(word.begin(), word.end(), [](unsigned char c) { return std::isupper(c) != 0; })) {
+    std::string lower = word;
+    to_lower_inplace(lower);
+    id = word_id(lower);
+  } else {
+    id = word_id(word);
+  }
+  if (id < 0 || is_word_used(id)) return;
+  move_log.push_back(applyMove(id, false));
+}
 
-  word_chain.push_back(lower);
-  used_words.insert(lower);
+GameMove ShiritoriGame::applyMove(uint32_t id, bool by_ai) {
+  GameMove move;
+  move.word = id;
+  move.by_ai = by_ai;
+  move.solved_slot = -1;
+  move.turns_since_heart_loss = turns_since_heart_loss;
+  move.player_hearts = player_hearts;
+  move.player_points = player_points;
+  move.state_version = state_version;
+  move.prefix_len = static_cast<uint8_t>(std::min<size_t>(current_prefix.length(), MAX_PREFIX_LEN));
+  std::copy(current_prefix.begin(), current_prefix.begin() + move.prefix_len, move.prefix);
+
+  // The player answers current_prefix; the AI answers the previous word, and
+  // an AI word answering nothing restarts the chain
+  int slot = -1;
+  if (!by_ai) {
+    slot = solved_slot(current_prefix);
+  } else if (!word_chain.empty()) {
+    std::string answered = find_valid_prefix(dict[word_chain.back()], get_difficulty_level(turns_since_heart_loss));
+    if (!answered.empty()) slot = solved_slot(answered);
+  }
+  if (slot >= 0 && !solved_prefixes[slot]) {
+    solved_prefixes[slot] = 1;
+    move.solved_slot = slot;
+    ++used_epoch;
+  }
+
+  word_chain.push_back(id);
+  mark_used(id);
   ++turn_count;
   ++turns_since_heart_loss;
+  ++state_version;
 
-  solved_suffixes.insert(current_prefix);
-
-  if (std::find(last_top_moves.begin(), last_top_moves.end(), lower) != last_top_moves.end()) {
+  if (by_ai) {
+    current_prefix = find_valid_prefix(dict[id], get_difficulty_level(turns_since_heart_loss));
+  } else if (std::find(last_top_moves.begin(), last_top_moves.end(), id) != last_top_moves.end()) {
     ++player_points;
     if (player_points >= POINTS_FOR_HEART) {
       ++player_hearts;
       player_points = 0;
     }
   }
+  return move;
+}
+
+void ShiritoriGame::undoMove(const GameMove& move) {
+  if (move.solved_slot >= 0) {
+    solved_prefixes[move.solved_slot] = 0;
+    ++used_epoch;
+  }
+  word_chain.pop_back();
+  unmark_used(move.word);
+  --turn_count;
+  turns_since_heart_loss = move.turns_since_heart_loss;
+  player_hearts = move.player_hearts;
+  player_points = move.player_points;
+  state_version = move.state_version;
+  current_prefix.assign(move.prefix, move.prefix_len);
+}
+
+namespace {
+
+inline uint64_t digest_mix(uint64_t hash, uint64_t value) {
+  hash = (hash ^ value) * 0x100000001b3ull;
+  return hash ^ (hash >> 29);
+}
+
+template <typename T>
+uint64_t digest_values(uint64_t hash, const T* values, size_t count) {
+  hash = digest_mix(hash, count);
+  for (size_t i = 0; i < count; ++i) hash = digest_mix(hash, static_cast<uint64_t>(values[i]));
+  return hash;
+}
+
+} // namespace
+
+uint64_t ShiritoriGame::stateDigest() const {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  hash = digest_values(hash, used_bits.data(), used_bits.size());
+  hash = digest_values(hash, prefix_unused.data(), prefix_unused.size());
+  hash = digest_values(hash, prefix_unused_length.data(), prefix_unused_length.size());
+  hash = digest_values(hash, exhausted_prefixes.data(), exhausted_prefixes.size());
+  for (const PrefixPostings* postings : {&solutions_by_obscurity, &solutions_by_length}) {
+    hash = digest_values(hash, postings->cursor.data(), postings->cursor.size());
+    hash = digest_values(hash, postings->head.data(), postings->head.size());
+  }
+  hash = digest_values(hash, solved_prefixes.data(), solved_prefixes.size());
+  hash = digest_values(hash, word_chain.data(), word_chain.size());
+  hash = digest_values(hash, current_prefix.data(), current_prefix.size());
+  const int64_t counters[] = {turn_count, turns_since_heart_loss, player_hearts, player_points,
+                              static_cast<int64_t>(state_version)};
+  return digest_values(hash, counters, sizeof(counters) / sizeof(counters[0]));
+}
+
+bool ShiritoriGame::postingCursorsMatchScan() const {
+  for (const PrefixPostings* postings : {&solutions_by_obscurity, &solutions_by_length}) {
+    for (size_t slot = 0; slot < prefix_ranges.size(); ++slot) {
+      const PrefixRange& range = prefix_ranges[slot];
+      const uint32_t* words = postings->words.data() + (prefix_table_len(static_cast<int>(slot)) - 1) * dict.size();
+      uint32_t first = range.begin;
+      while (first < range.end && is_word_used(words[first])) ++first;
+      const uint32_t head = first < range.end ? words[first] : NO_WORD;
+      if (postings->cursor[slot] != first || postings->head[slot] != head) return false;
+    }
+  }
+  return true;
+}
+
+// Every prefix a move can answer is a word suffix of at most MAX_PREFIX_LEN
+// letters, or empty
+int ShiritoriGame::solved_slot(const std::string& prefix) const {
+  if (prefix.empty()) return PREFIX_TABLE_SIZE;
+  return prefix_table_id(prefix.data(), static_cast<int>(prefix.length()));
+}
+
+bool ShiritoriGame::is_solved(const std::string& prefix) const {
+  int slot = solved_slot(prefix);
+  return slot >= 0 && static_cast<size_t>(slot) < solved_prefixes.size() && solved_prefixes[slot];
+}
+
+std::string_view ShiritoriGame::creates_prefix(uint32_t id) const {
+  std::string_view word = dict[id];
+  return word.substr(word.length() - word_features[id].creates_prefix_len);
+}
+
+PrefixRange ShiritoriGame::creates_prefix_range(uint32_t id) const {
+  const int32_t slot = word_features[id].creates_prefix_id;
+  if (slot >= 0) return prefix_ranges[slot];
+  std::string_view prefix = creates_prefix(id);
+  return prefix_range(prefix.data(), static_cast<int>(prefix.length()));
+}
+
+int ShiritoriGame::creates_prefix_unused(uint32_t id) const {
+  const int32_t slot = word_features[id].creates_prefix_id;
+  if (slot >= 0) return exhausted_prefixes[slot] ? 0 : static_cast<int>(prefix_unused[slot]);
+  return countSolutions(std::string(creates_prefix(id)));
+}
+
+bool ShiritoriGame::creates_prefix_solved(uint32_t id) const {
+  const int32_t slot = word_features[id].creates_prefix_id;
+  if (slot >= 0) return solved_prefixes[slot] != 0;
+  return is_solved(std::string(creates_prefix(id)));
+}
+
+void ShiritoriGame::creates_prefix_best(uint32_t id, int& max_solution_len, double* best_obscurity) const {
+  const int32_t slot = word_features[id].creates_prefix_id;
+  if (slot >= 0) {
+    const uint32_t longest = solutions_by_length.head[slot];
+    const uint32_t most_obscure = solutions_by_obscurity.head[slot];
+    max_solution_len = longest != NO_WORD ? static_cast<int>(dict[longest].length()) : 0;
+    if (best_obscurity) {
+      *best_obscurity = most_obscure != NO_WORD ? std::max(0.0, word_features[most_obscure].obscurity) : 0.0;
+    }
+    return;
+  }
+
+  max_solution_len = 0;
+  double best = 0.0;
+  PrefixRange sol_range = creates_prefix_range(id);
+  for (uint32_t s = sol_range.begin; s < sol_range.end; ++s) {
+    if (!is_word_used(s)) {
+      best = std::max(best, word_features[s].obscurity);
+      max_solution_len = std::max(max_solution_len, (int)dict[s].length());
+    }
+  }
+  if (best_obscurity) *best_obscurity = best;
+  TURN_PROFILE_COUNT(turn_profile, entries_scanned, sol_range.end - sol_range.begin);
+  TURN_PROFILE_COUNT(turn_profile, used_probes, sol_range.end - sol_range.begin);
+}
+
+int ShiritoriGame::getWordId(const std::string& word) const {
+  std::string lower = word;
+  to_lower_inplace(lower);
+  return word_id(lower);
+}
+
+std::vector<std::string> ShiritoriGame::getWordChain() const {
+  std::vector<std::string> chain;
+  chain.reserve(word_chain.size());
+  for (uint32_t id : word_chain) chain.emplace_back(dict[id]);
+  return chain;
 }
 
 void ShiritoriGame::losePlayerHeart() {
   if (player_hearts > 0) player_hearts -= 1;
   player_points = 0;
   turns_since_heart_loss = 0;
+  ++state_version;
 }
 
 bool ShiritoriGame::wasTopSolve(const std::string& word) const {
   std::string lower = word;
   to_lower_inplace(const_cast<std::string&>(lower));
-  return std::find(last_top_moves.begin(), last_top_moves.end(), lower) != last_top_moves.end();
+  int id = word_id(lower);
+  return id >= 0 && std::find(last_top_moves.begin(), last_top_moves.end(), static_cast<uint32_t>(id)) != last_top_moves.end();
 }
 
 std::string ShiritoriGame::getNewPrefix(const std::string& word, int difficulty) const {
   return find_valid_prefix(word, difficulty);
 }
 
-std::string ShiritoriGame::getAIMove() {
+std::string_view ShiritoriGame::getAIMove(const std::atomic<bool>* cancel) {
+  TRACE_SPAN("ShiritoriGame::getAIMove");
   if (word_chain.empty()) return "";
 
-  const std::string& last_word = word_chain.back();
+  std::string_view last_word = dict[word_chain.back()];
   int difficulty = get_difficulty_level(turns_since_heart_loss);
 
   std::string prefix = find_valid_prefix(last_word, difficulty);
@@ -616,200 +1519,196 @@ std::string ShiritoriGame::getAIMove() {
     if (dict.empty()) return "";
 
     std::uniform_int_distribution<> dis(0, std::min(1000, static_cast<int>(dict.size()) - 1));
-    std::string word;
+    int id;
     int attempts = 0;
     do {
-      word = dict[dis(rng)];
+      id = dis(rng);
       ++attempts;
       if (attempts > 100) break;
-    } while (used_words.count(word) > 0);
+    } while (is_word_used(id));
 
-    if (used_words.count(word) > 0) return "";
+    if (is_word_used(id)) return "";
 
-    word_chain.push_back(word);
-    used_words.insert(word);
-    ++turn_count;
-    ++turns_since_heart_loss;
+    commit_ai_word(id);
+    refresh_last_top_moves();
 
-    current_prefix = find_valid_prefix(word, get_difficulty_level(turns_since_heart_loss));
+    return dict[id];
+  }
 
-    auto top_moves_ranked = getTopAIMoves(current_prefix, 5);
-    last_top_moves.clear();
-    for (const auto& move : top_moves_ranked) {
-      last_top_moves.push_back(move.word);
+  if (ai_engine != AIEngine::Heuristic) {
+    int id = ai_engine == AIEngine::Search ? search_best_move(prefix, cancel)
+                                           : monte_carlo_best_move(prefix, cancel);
+    if (is_cancelled(cancel)) return "";
+    if (id >= 0) {
+      commit_ai_word(id);
+      refresh_last_top_moves();
+      return dict[id];
     }
-
-    return word;
   }
 
-  // STEP 1: Collect ALL unused words with the required prefix
-  std::vector<WordRank> all_candidates;
-  all_candidates.reserve(500);
-
-  auto it = std::lower_bound(dict.begin(), dict.end(), prefix);
-
-  while (it != dict.end() && it->rfind(prefix, 0) == 0) {
-    if (used_words.count(*it) == 0) {
-      WordRank wr;
-      wr.word = *it;
-
-      // Find best creates-prefix
-      auto prefix_info = find_best_prefix_static_cached_local(wr.word, prefix_count_cache, BLACKLIST_SUFFIXES, dict);
-      wr.creates_prefix = prefix_info.first;
-      wr.is_blacklisted = is_prefix_blacklisted(wr.creates_prefix);
-      wr.is_self_solving = is_prefix_self_solving(wr.creates_prefix);
-
-      // Check if word itself is obscure
-      wr.is_obscure_word = false;
-      wr.obscure_suffix_length = 0;
-      for (int len = MAX_PREFIX_LEN; len >= 2; --len) {
-        std::string suffix = get_suffix(wr.word, len);
-        auto itc = prefix_count_cache.find(suffix);
-        if (itc != prefix_count_cache.end() && itc->second <= OBSCURE_THRESHOLD) {
-          wr.is_obscure_word = true;
-          wr.obscure_suffix_length = len;
-          break;
+  // Every container below lives in the per-turn scratch arena. Candidates are
+  // held column-wise, one array per ranking term, and addressed by row.
+  ScratchArena::Scope scratch_scope(scratch);
+
+  // STEP 1: Collect the unused words with the required prefix, then score
+  // them. Words whose creates-prefix is a rare pattern are ranked on their own
+  // first; all unused words are ranked only when none of those is left or
+  // none of them passes the lookahead. This is a preference, not a shortcut:
+  // a rare candidate that passes wins over higher-scoring ordinary words.
+  PrefixRange range = prefix_range(prefix);
+  const size_t LOOKAHEAD_CANDIDATES = 100;
+  ScratchVector<uint32_t> ids(scratch);
+  ScratchVector<int32_t> solutions(scratch);
+  ScratchVector<int32_t> max_solution_len(scratch);
+  ScratchVector<double> totals(scratch);
+  ScratchVector<uint32_t> order(scratch);
+  ScratchVector<uint32_t> viable_candidates(scratch);
+  ids.reserve(range.end - range.begin);
+  for (bool rare_only : {true, false}) {
+    ids.clear();
+    {
+      TURN_PROFILE_SCOPE(turn_profile, PHASE_COLLECT);
+      if (rare_only) {
+        collect_pattern_words(range, ids);
+      } else {
+        for (uint32_t i = range.begin; i < range.end; ++i) {
+          if (!is_word_used(i)) ids.push_back(i);
         }
+        TURN_PROFILE_COUNT(turn_profile, entries_scanned, range.end - range.begin);
+        TURN_PROFILE_COUNT(turn_profile, used_probes, range.end - range.begin);
       }
-
-      // Collect UNUSED solutions
-      std::vector<std::string> solutions;
-      int solution_count = 0;
-      int max_solution_length = 0;
-
-      if (!wr.creates_prefix.empty()) {
-        auto sol_it = std::lower_bound(dict.begin(), dict.end(), wr.creates_prefix);
-        while (sol_it != dict.end() && sol_it->rfind(wr.creates_prefix, 0) == 0) {
-          if (used_words.count(*sol_it) == 0) {
-            solutions.push_back(*sol_it);
-            solution_count++;
-            max_solution_length = std::max(max_solution_length, (int)sol_it->length());
-          }
-          ++sol_it;
-        }
+    }
+    if (rare_only && ids.empty()) continue;
+
+    const size_t candidate_count = ids.size();
+    solutions.assign(candidate_count, 0);
+    max_solution_len.assign(candidate_count, 0);
+    totals.assign(candidate_count, 0.0);
+    {
+      TURN_PROFILE_SCOPE(turn_profile, PHASE_SCORE);
+      const size_t SCORE_BATCH = 256;
+      for (size_t first = 0; first < candidate_count; first += SCORE_BATCH) {
+        if (is_cancelled(cancel)) return "";
+        const size_t n = std::min(SCORE_BATCH, candidate_count - first);
+        score_candidates(ids.data() + first, n, solutions.data() + first, max_solution_len.data() + first,
+            totals.data() + first);
       }
+      TURN_PROFILE_COUNT(turn_profile, candidates, candidate_count);
+    }
 
-      wr.creates_prefix_solutions = solution_count;
-      wr.max_solution_len = max_solution_length;
-
-      // Calculate scores
-      wr.obscurity_score = calculateObscurityScoreLocal(wr.creates_prefix, solution_count, solutions);
-
-      double total = 0.0;
-
-      // Penalize heavily if no solutions
-      if (solution_count == 0) {
-        total = -10000.0;
-      } else {
-        total += 10000.0 / solution_count;
-        total += wr.obscurity_score * 15.0;
-        total += (max_solution_length - 5) * 30.0;
-        if (wr.is_obscure_word) {
-          total += 1500.0 + wr.obscure_suffix_length * 100.0;
+    if (candidate_count == 0) return "";
+
+    // STEP 2: Sort by total score (best first). Only the row order moves; dict
+    // is sorted, so word order is ID order.
+    //
+    // Nothing past the first LOOKAHEAD_CANDIDATES rows is ever looked at, so
+    // rows more than the tie margin below the LOOKAHEAD_CANDIDATES-th best total
+    // are left out of the sort. With no two distinct totals within the margin of
+    // each other among the rest, the comparator orders them consistently and the
+    // prefix of the order is the one a full sort gives; otherwise every row is
+    // sorted as before.
+    order.clear();
+    {
+      TURN_PROFILE_SCOPE(turn_profile, PHASE_SORT);
+      order.reserve(candidate_count);
+      if (candidate_count > LOOKAHEAD_CANDIDATES) {
+        ScratchVector<double> sorted_totals(totals.begin(), totals.end(), scratch);
+        std::nth_element(sorted_totals.begin(), sorted_totals.begin() + (LOOKAHEAD_CANDIDATES - 1),
+            sorted_totals.end(), std::greater<double>());
+        const double cutoff = sorted_totals[LOOKAHEAD_CANDIDATES - 1];
+        sorted_totals.clear();
+        for (size_t row = 0; row < candidate_count; ++row) {
+          if (cutoff - totals[row] > 0.001) continue;
+          order.push_back(static_cast<uint32_t>(row));
+          sorted_totals.push_back(totals[row]);
+        }
+        std::sort(sorted_totals.begin(), sorted_totals.end());
+        for (size_t i = 1; i < sorted_totals.size(); ++i) {
+          if (sorted_totals[i] != sorted_totals[i - 1] && sorted_totals[i] - sorted_totals[i - 1] <= 0.001) {
+            order.clear();
+            break;
+          }
         }
-        total += wr.creates_prefix.length() * 50.0;
-      }
-
-      // Penalize blacklisted/self-solving but don't exclude
-      if (wr.is_blacklisted || wr.is_self_solving) {
-        total -= 5000.0;
       }
-
-      // Penalize if already solved
-      if (solved_suffixes.count(wr.creates_prefix) > 0) {
-        total -= 3000.0;
+      if (order.empty()) {
+        for (size_t row = 0; row < candidate_count; ++row) order.push_back(static_cast<uint32_t>(row));
       }
-
-      wr.total_score = total;
-      wr.difficulty_level = (int)wr.creates_prefix.length();
-
-      all_candidates.push_back(wr);
+      const double* total = totals.data();
+      const int32_t* max_len = max_solution_len.data();
+      const uint32_t* id = ids.data();
+      std::sort(order.begin(), order.end(), [total, max_len, id](uint32_t a, uint32_t b) {
+          if (std::abs(total[a] - total[b]) > 0.001) return total[a] > total[b];
+          if (max_len[a] != max_len[b]) return max_len[a] > max_len[b];
+          return id[a] < id[b];
+          });
     }
-    ++it;
-  }
-
-  if (all_candidates.empty()) return "";
-
-  // STEP 2: Sort by total score (best first)
-  std::sort(all_candidates.begin(), all_candidates.end(), [](const WordRank& a, const WordRank& b) {
-      if (std::abs(a.total_score - b.total_score) > 0.001) return a.total_score > b.total_score;
-      if (a.max_solution_len != b.max_solution_len) return a.max_solution_len > b.max_solution_len;
-      return a.word < b.word;
+    const size_t ranked = order.size();
+
+    // STEP 3: Try lookahead validation on top candidates
+    viable_candidates.clear();
+    viable_candidates.reserve(ranked);
+
+    // Try top 100 candidates with lookahead, spread over the worker pool. Each
+    // check only reads shared state and fills its own slot, so the outcome does
+    // not depend on scheduling.
+    size_t check_limit = std::min(ranked, LOOKAHEAD_CANDIDATES);
+    ScratchVector<uint8_t> passed(check_limit, 0, scratch);
+    struct Lookahead {
+      const uint32_t* order;
+      const uint32_t* ids;
+      const double* totals;
+      uint8_t* passed;
+      const std::atomic<bool>* cancel;
+      int player_difficulty;
+      int ai_next_difficulty;
+    } lookahead{order.data(), ids.data(), totals.data(), passed.data(), cancel,
+                get_difficulty_level(turns_since_heart_loss + 1), get_difficulty_level(turns_since_heart_loss + 2)};
+
+    {
+      TURN_PROFILE_SCOPE(turn_profile, PHASE_LOOKAHEAD);
+      TRACE_SPAN("lookahead");
+      // Two captures keep the std::function in its small buffer
+      worker_pool().parallel_for(check_limit, [this, &lookahead](size_t i) {
+        if (is_cancelled(lookahead.cancel)) return;
+        const uint32_t row = lookahead.order[i];
+        lookahead.passed[i] = lookahead_allows_reply(lookahead.ids[row], lookahead.totals[row],
+            lookahead.player_difficulty, lookahead.ai_next_difficulty);
       });
+    }
+    if (is_cancelled(cancel)) return "";
 
-  // STEP 3: Try lookahead validation on top candidates
-  std::vector<WordRank> viable_candidates;
-  viable_candidates.reserve(all_candidates.size());
-
-  // Try top 100 candidates with lookahead
-  size_t check_limit = std::min(all_candidates.size(), static_cast<size_t>(100));
-
-  for (size_t i = 0; i < check_limit; ++i) {
-    const auto& candidate = all_candidates[i];
-
-    // Skip if score is too negative (bad moves)
-    if (candidate.total_score < -8000.0) continue;
-
-    int player_difficulty = get_difficulty_level(turns_since_heart_loss + 1);
-    std::string viable_player_prefix = find_valid_prefix(candidate.word, player_difficulty);
-
-    if (viable_player_prefix.empty()) continue;
-
-    // Temporarily mark as used to test player moves
-    used_words.insert(candidate.word);
-    bool ai_can_continue = false;
-
-    auto player_it = std::lower_bound(dict.begin(), dict.end(), viable_player_prefix);
+    for (size_t i = 0; i < check_limit; ++i) {
+      if (passed[i]) viable_candidates.push_back(order[i]);
+    }
 
-    // Check if any player response allows AI to continue
-    int checked = 0;
-    while (player_it != dict.end() && player_it->rfind(viable_player_prefix, 0) == 0 && checked < 50) {
-      if (used_words.count(*player_it) == 0) {
-        int ai_next_difficulty = get_difficulty_level(turns_since_heart_loss + 2);
-        std::string ai_next_prefix = find_valid_prefix(*player_it, ai_next_difficulty);
+    if (viable_candidates.empty() && rare_only) continue;
 
-        if (!ai_next_prefix.empty() && has_unused_words(ai_next_prefix)) {
-          ai_can_continue = true;
-          break;
+    // STEP 4: Fallback - if no viable candidates with lookahead, use best scored candidates anyway
+    if (viable_candidates.empty()) {
+      // Take top 20 candidates regardless of lookahead
+      size_t fallback_size = std::min(ranked, static_cast<size_t>(20));
+      for (size_t i = 0; i < fallback_size; ++i) {
+        if (totals[order[i]] > -8000.0) {
+          viable_candidates.push_back(order[i]);
         }
       }
-      ++player_it;
-      ++checked;
-    }
-
-    used_words.erase(candidate.word);
-
-    if (ai_can_continue) {
-      viable_candidates.push_back(candidate);
     }
-  }
 
-  // STEP 4: Fallback - if no viable candidates with lookahead, use best scored candidates anyway
-  if (viable_candidates.empty()) {
-    // Take top 20 candidates regardless of lookahead
-    size_t fallback_size = std::min(all_candidates.size(), static_cast<size_t>(20));
-    for (size_t i = 0; i < fallback_size; ++i) {
-      if (all_candidates[i].total_score > -8000.0) {
-        viable_candidates.push_back(all_candidates[i]);
-      }
+    // If still no candidates, take anything available
+    if (viable_candidates.empty()) {
+      viable_candidates.push_back(order[0]);
     }
+    break;
   }
 
-  // If still no candidates, take anything available
-  if (viable_candidates.empty() && !all_candidates.empty()) {
-    viable_candidates.push_back(all_candidates[0]);
-  }
-
-  if (viable_candidates.empty()) return "";
-
   // STEP 5: Shuffle within difficulty tiers for variety
   size_t start_idx = 0;
   while (start_idx < viable_candidates.size()) {
-    int current_count = viable_candidates[start_idx].creates_prefix_solutions;
+    int current_count = solutions[viable_candidates[start_idx]];
     size_t end_idx = start_idx;
 
     while (end_idx < viable_candidates.size() &&
-        viable_candidates[end_idx].creates_prefix_solutions == current_count) {
+        solutions[viable_candidates[end_idx]] == current_count) {
       ++end_idx;
     }
 
@@ -824,101 +1723,292 @@ std::string ShiritoriGame::getAIMove() {
   }
 
   // STEP 6: Select the best viable candidate
-  std::string ai_word = viable_candidates[0].word;
-  word_chain.push_back(ai_word);
-  used_words.insert(ai_word);
-  ++turn_count;
-  ++turns_since_heart_loss;
+  const uint32_t ai_id = ids[viable_candidates[0]];
+  commit_ai_word(ai_id);
+  refresh_last_top_moves();
 
-  solved_suffixes.insert(prefix);
+  return dict[ai_id];
+}
 
-  current_prefix = find_valid_prefix(ai_word, get_difficulty_level(turns_since_heart_loss));
+// Whether some player reply to candidate `id` still leaves the AI a prefix to
+// answer, with the candidate tentatively used
+bool ShiritoriGame::lookahead_allows_reply(uint32_t id, double total_score, int player_difficulty,
+    int ai_next_difficulty) const {
+  // Skip if score is too negative (bad moves)
+  if (total_score < -8000.0) return false;
 
-  auto top_moves_ranked = getTopAIMoves(current_prefix, 5);
-  last_top_moves.clear();
-  for (const auto& move : top_moves_ranked) {
-    last_top_moves.push_back(move.word);
+  std::string viable_player_prefix = find_valid_prefix(dict[id], player_difficulty);
+  if (viable_player_prefix.empty()) return false;
+
+  UsedOverlay overlay;
+  overlay.add(id);
+
+  PrefixRange player_range = prefix_range(viable_player_prefix);
+
+  // Check if any player response allows AI to continue
+  int checked = 0;
+  for (uint32_t p = player_range.begin; p < player_range.end && checked < 50; ++p, ++checked) {
+    if (!is_word_used(p, overlay)) {
+      std::string ai_next_prefix = find_valid_prefix(dict[p], ai_next_difficulty, overlay);
+      if (!ai_next_prefix.empty() && count_unused(ai_next_prefix, overlay) > 0) return true;
+    }
   }
+  return false;
+}
 
-  return ai_word;
+bool ShiritoriGame::is_word_used(uint32_t id, const UsedOverlay& overlay) const {
+  for (int i = 0; i < overlay.count; ++i) {
+    if (overlay.ids[i] == id) return true;
+  }
+  return is_word_used(id);
 }
 
-std::vector<WordRank> ShiritoriGame::getRegularSolves(const std::string& required_prefix, int max_n) {
-  std::vector<WordRank> candidates;
-  candidates.reserve(max_n * 2);
+int ShiritoriGame::count_unused(const std::string& prefix, const UsedOverlay& overlay) const {
+  int count = countSolutions(prefix);
+  for (int i = 0; i < overlay.count; ++i) {
+    if (dict[overlay.ids[i]].compare(0, prefix.length(), prefix) == 0) --count;
+  }
+  return count;
+}
 
-  auto it = std::lower_bound(dict.begin(), dict.end(), required_prefix);
+std::string ShiritoriGame::find_valid_prefix(std::string_view word, int max_difficulty,
+    const UsedOverlay& overlay) const {
+  for (int len = max_difficulty; len >= 1; --len) {
+    std::string prefix = get_suffix(word, len);
+    if (count_unused(prefix, overlay) > 0) return prefix;
+  }
+  return "";
+}
 
-  int count = 0;
+// Created on first use so games that never search start no threads
+WorkStealingPool& ShiritoriGame::worker_pool() {
+  if (!pool) pool.reset(new WorkStealingPool(worker_threads));
+  return *pool;
+}
 
-  // Collect ANY unused words with the prefix - minimal filtering
-  while (it != dict.end() && it->rfind(required_prefix, 0) == 0) {
-    if (used_words.count(*it) == 0) {
-      WordRank wr;
-      wr.word = *it;
-
-      // Find what prefix this word creates (even if not ideal)
-      std::string creates_prefix = "";
-      int solution_count = 0;
-
-      // Try to find ANY valid prefix this word creates
-      for (int len = MAX_PREFIX_LEN; len >= 1; --len) {
-        std::string potential_prefix = get_suffix(wr.word, len);
-
-        // Count solutions for this potential prefix
-        int temp_count = 0;
-        auto sol_it = std::lower_bound(dict.begin(), dict.end(), potential_prefix);
-        while (sol_it != dict.end() && sol_it->rfind(potential_prefix, 0) == 0) {
-          if (used_words.count(*sol_it) == 0) {
-            temp_count++;
-          }
-          ++sol_it;
-        }
+void ShiritoriGame::setWorkerThreads(unsigned threads) {
+  worker_threads = threads;
+  pool.reset();
+}
 
-        // Take the first prefix that has ANY solutions
-        if (temp_count > 0) {
-          creates_prefix = potential_prefix;
-          solution_count = temp_count;
-          break;
+// The moves that earn the player a point on their next turn
+void ShiritoriGame::refresh_last_top_moves() {
+  const RankedMoves* ranked = rank_top_moves(current_prefix, nullptr);
+  const size_t count = ranked ? std::min<size_t>(ranked->size(), 5) : 0;
+  last_top_moves.clear();
+  for (size_t rank = 0; rank < count; ++rank) last_top_moves.push_back(ranked->id(rank));
+}
+
+// The terms getAIMove ranks an unused candidate by, from the AI's side: a
+// higher total leaves the player fewer and harder replies. Each term goes to
+// its own array, row k describing ids[k].
+void ShiritoriGame::score_candidates(const uint32_t* ids, size_t count, int32_t* solutions,
+    int32_t* max_solution_len, double* totals) const {
+  for (size_t k = 0; k < count; ++k) {
+    const uint32_t id = ids[k];
+    const WordFeatures& features = word_features[id];
+    const std::string_view prefix = creates_prefix(id);
+    const int32_t slot = features.creates_prefix_id;
+
+    // Count UNUSED solutions; the prefix slot keeps their count and length
+    int solution_count = 0;
+    int max_solution_length = 0;
+    size_t total_solution_len = 0;
+
+    if (slot >= 0) {
+      solution_count = creates_prefix_unused(id);
+      if (solution_count > 0) {
+        total_solution_len = prefix_unused_length[slot];
+        creates_prefix_best(id, max_solution_length, nullptr);
+      }
+    } else if (!prefix.empty()) {
+      PrefixRange sol_range = creates_prefix_range(id);
+      for (uint32_t s = sol_range.begin; s < sol_range.end; ++s) {
+        if (!is_word_used(s)) {
+          int len = static_cast<int>(dict[s].length());
+          solution_count++;
+          total_solution_len += len;
+          max_solution_length = std::max(max_solution_length, len);
         }
       }
+      TURN_PROFILE_COUNT(turn_profile, entries_scanned, sol_range.end - sol_range.begin);
+      TURN_PROFILE_COUNT(turn_profile, used_probes, sol_range.end - sol_range.begin);
+    }
 
-      // If no prefix with solutions found, just use the longest suffix
-      if (creates_prefix.empty()) {
-        creates_prefix = get_suffix(wr.word, std::min(MAX_PREFIX_LEN, (int)wr.word.length()));
-        solution_count = 0;
-      }
+    solutions[k] = solution_count;
+    max_solution_len[k] = max_solution_length;
+    totals[k] = candidate_total(prefix, features, solution_count, max_solution_length, total_solution_len,
+        creates_prefix_solved(id));
+  }
+}
+
+double ShiritoriGame::score_candidate(uint32_t id) const {
+  int32_t solutions, max_solution_len;
+  double total;
+  score_candidates(&id, 1, &solutions, &max_solution_len, &total);
+  return total;
+}
+
+// Shared by every way the AI can play a word
+void ShiritoriGame::commit_ai_word(uint32_t id) {
+  move_log.push_back(applyMove(id, true));
+}
+
+ShiritoriGame::TurnCheckpoint ShiritoriGame::save_checkpoint() const {
+  return {move_log.size(), last_top_moves, rng};
+}
+
+void ShiritoriGame::restore_checkpoint(const TurnCheckpoint& checkpoint) {
+  while (move_log.size() > checkpoint.moves_played) {
+    undoMove(move_log.back());
+    move_log.pop_back();
+  }
+  last_top_moves = checkpoint.last_top_moves;
+  rng = checkpoint.rng;
+}
 
-      wr.creates_prefix = creates_prefix;
-      wr.creates_prefix_solutions = solution_count;
+void ShiritoriGame::speculateReplies(const std::vector<std::string>& player_words,
+    const std::atomic<bool>* cancel) {
+  TRACE_SPAN("ShiritoriGame::speculateReplies");
+  speculative_replies.clear();
+  speculation_version = state_version;
+
+  for (const auto& candidate : player_words) {
+    if (is_cancelled(cancel)) break;
+
+    std::string word = candidate;
+    to_lower_inplace(word);
+    int id = word_id(word);
+    if (id < 0 || is_word_used(id)) continue;
+    bool seen = false;
+    for (const auto& reply : speculative_replies) seen = seen || reply.player_word == word;
+    if (seen) continue;
+
+    TurnCheckpoint checkpoint = save_checkpoint();
+    processPlayerWord(word);
+
+    SpeculativeReply reply;
+    reply.player_word = word;
+    reply.ai_word = getAIMove(cancel);
+    bool complete = !is_cancelled(cancel);
+    if (complete && !reply.ai_word.empty() && !current_prefix.empty()) {
+      reply.top_moves = getTopAIMoves(current_prefix, TOP_MOVES_TO_SHOW, cancel);
+      reply.regular_moves = getRegularSolves(current_prefix, 5);
+      complete = !is_cancelled(cancel);
+    }
+    reply.ai_top_moves = last_top_moves;
+    reply.rng_after = rng;
+
+    restore_checkpoint(checkpoint);
+    if (!complete) break;
+    speculative_replies.push_back(std::move(reply));
+  }
+}
+
+const SpeculativeReply* ShiritoriGame::playSpeculatedAIMove() {
+  // The stored replies only hold if the player's word is the one change since
+  if (word_chain.empty() || speculation_version == NO_SPECULATION ||
+      speculation_version + 1 != state_version) {
+    return nullptr;
+  }
+  speculation_version = NO_SPECULATION;
 
-      candidates.push_back(wr);
-      count++;
+  std::string_view player_word = dict[word_chain.back()];
+  for (const auto& reply : speculative_replies) {
+    if (reply.player_word != player_word) continue;
 
-      // Stop once we have enough
-      if (candidates.size() >= static_cast<size_t>(max_n)) {
+    ++speculation_hits;
+    if (!reply.ai_word.empty()) {
+      commit_ai_word(word_id(reply.ai_word));
+      last_top_moves = reply.ai_top_moves;
+    }
+    rng = reply.rng_after;
+    return &reply;
+  }
+
+  ++speculation_misses;
+  return nullptr;
+}
+
+std::vector<WordRank> ShiritoriGame::getRegularSolves(const std::string& required_prefix, int max_n) {
+  std::vector<WordRank> moves;
+  getRegularSolves(required_prefix, max_n, moves);
+  return moves;
+}
+
+size_t ShiritoriGame::getRegularSolves(const std::string& required_prefix, int max_n,
+    std::vector<WordRank>& moves) {
+  TURN_PROFILE_SCOPE(turn_profile, PHASE_REGULAR_SOLVES);
+  TRACE_SPAN("ShiritoriGame::getRegularSolves");
+  ScratchArena::Scope scratch_scope(scratch);
+  // A candidate's creates-prefix is the last prefix_len letters of its word
+  struct Candidate {
+    uint32_t id;
+    int prefix_len;
+    int solutions;
+  };
+  const size_t limit = static_cast<size_t>(std::max(max_n, 0));
+  ScratchVector<Candidate> candidates(scratch);
+  candidates.reserve(limit);
+
+  PrefixRange range = prefix_range(required_prefix);
+
+  // Collect ANY unused words with the prefix - minimal filtering
+  for (uint32_t i = range.begin; i < range.end && candidates.size() < limit; ++i) {
+    TURN_PROFILE_COUNT(turn_profile, entries_scanned, 1);
+    TURN_PROFILE_COUNT(turn_profile, used_probes, 1);
+    if (is_word_used(i)) continue;
+
+    // Take the longest suffix with ANY solutions; if none has, just use the
+    // longest suffix
+    std::string_view word = dict[i];
+    Candidate candidate{i, std::min(MAX_PREFIX_LEN, (int)word.length()), 0};
+    for (int len = MAX_PREFIX_LEN; len >= 1; --len) {
+      int temp_count = countSolutions(get_suffix(word, len));
+      TURN_PROFILE_COUNT(turn_profile, used_probes, 1);
+      if (temp_count > 0) {
+        candidate.prefix_len = std::min(len, (int)word.length());
+        candidate.solutions = temp_count;
         break;
       }
     }
-    ++it;
+    candidates.push_back(candidate);
+    TURN_PROFILE_COUNT(turn_profile, candidates, 1);
   }
 
-  // Sort by solution count (ascending - fewer is harder, but we show them anyway)
-  std::sort(candidates.begin(), candidates.end(), [](const WordRank& a, const WordRank& b) {
+  // Sort by solution count (ascending - fewer is harder, but we show them
+  // anyway). dict is sorted, so word order is ID order.
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
       // Prioritize words that create prefixes with solutions
-      if (a.creates_prefix_solutions > 0 && b.creates_prefix_solutions == 0) return true;
-      if (a.creates_prefix_solutions == 0 && b.creates_prefix_solutions > 0) return false;
+      if (a.solutions > 0 && b.solutions == 0) return true;
+      if (a.solutions == 0 && b.solutions > 0) return false;
 
-      if (a.creates_prefix_solutions != b.creates_prefix_solutions) {
-      return a.creates_prefix_solutions < b.creates_prefix_solutions;
+      if (a.solutions != b.solutions) {
+      return a.solutions < b.solutions;
       }
-      return a.word < b.word;
+      return a.id < b.id;
       });
 
-  // Return at most max_n
-  if (candidates.size() > static_cast<size_t>(max_n)) {
-    candidates.resize(max_n);
+  if (moves.size() < candidates.size()) moves.resize(candidates.size());
+  for (size_t k = 0; k < candidates.size(); ++k) {
+    const Candidate& candidate = candidates[k];
+    std::string_view word = dict[candidate.id];
+    WordRank& wr = moves[k];
+    wr.word.assign(word);
+    wr.suffix.clear();
+    wr.prefix_solutions_count = 0;
+    wr.max_solution_len = 0;
+    wr.obscurity_score = 0.0;
+    wr.creates_prefix.assign(word.substr(word.length() - candidate.prefix_len));
+    wr.difficulty_level = candidate.prefix_len;
+    wr.creates_prefix_solutions = candidate.solutions;
+    wr.is_obscure_word = false;
+    wr.obscure_suffix_length = 0;
+    wr.total_score = 0.0;
+    wr.best_creates_prefix.clear();
+    wr.best_creates_prefix_solutions = 0;
+    wr.is_blacklisted = false;
+    wr.is_self_solving = false;
   }
-
-  return candidates;
+  return candidates.size();
 }
@@ -7,6 +7,15 @@
 #include <unordered_set>
 #include <random>
 #include <bitset>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <memory>
+#include "lexiconsnapshot.h"
+#include "scratcharena.h"
+#include "turnprofile.h"
+#include "workstealingpool.h"
 
 // Constants
 const int MAX_PREFIX_LEN = 4;
@@ -15,6 +24,46 @@ const int TOP_MOVES_TO_SHOW = 5;
 const int POINTS_FOR_HEART = 9;
 const int OBSCURE_THRESHOLD = 15;
 
+// Prefix length the next player must answer, by turns since the last heart loss
+inline int get_difficulty_level(int turns_since_reset) {
+  if (turns_since_reset <= 3) return 1;
+  else if (turns_since_reset <= 8) return 2;
+  else if (turns_since_reset <= 15) return 3;
+  else return 4;
+}
+// Turns after which get_difficulty_level no longer changes
+const int MAX_DIFFICULTY_STEP = 16;
+
+inline bool is_cancelled(const std::atomic<bool>* cancel) {
+  return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+// Every a-z string of length 1..MAX_PREFIX_LEN owns one slot in the prefix table
+const int PREFIX_TABLE_SIZE = 26 + 26 * 26 + 26 * 26 * 26 + 26 * 26 * 26 * 26;
+
+// Slot of a 1..MAX_PREFIX_LEN letter string in the dense prefix table, -1 if it has none
+inline int prefix_table_id(const char* s, int len) {
+  static const int offsets[MAX_PREFIX_LEN + 1] = {0, 0, 26, 26 + 26 * 26, 26 + 26 * 26 + 26 * 26 * 26};
+  if (len < 1 || len > MAX_PREFIX_LEN) return -1;
+  int code = 0;
+  for (int i = 0; i < len; ++i) {
+    unsigned c = static_cast<unsigned char>(s[i]) - 'a';
+    if (c >= 26) return -1;
+    code = code * 26 + static_cast<int>(c);
+  }
+  return offsets[len] + code;
+}
+
+// Prefix length of a prefix_table_id slot
+inline int prefix_table_len(int id) {
+  int len = 1;
+  for (int span = 26; id >= span && len < MAX_PREFIX_LEN; span *= 26) {
+    id -= span;
+    ++len;
+  }
+  return len;
+}
+
 // Blacklisted suffixes (common/trivial) - matches shiritori.cpp
 const std::unordered_set<std::string> BLACKLIST_SUFFIXES = {
     "ness", "ally", "ses", "sis", "lity", "ties", "hies", 
@@ -23,6 +72,48 @@ const std::unordered_set<std::string> BLACKLIST_SUFFIXES = {
     "bias", "ias", "ous", "ful", "less", "able", "ible", "nize", "tive", "onyx", "tion"
 };
 
+// [begin, end) indices into the sorted dictionary sharing one prefix
+struct PrefixRange {
+    uint32_t begin;
+    uint32_t end;
+};
+
+// Per-prefix-slot flags computed once by load_database
+enum PrefixFlag : uint8_t {
+    PREFIX_SELF_SOLVING = 1 << 0,
+    PREFIX_BLACKLISTED = 1 << 1
+};
+
+// Per-word flags computed once by load_database
+enum WordFlag : uint8_t {
+    WORD_ENDS_BLACKLISTED = 1 << 0,
+    WORD_CREATES_BLACKLISTED = 1 << 1,
+    WORD_CREATES_SELF_SOLVING = 1 << 2
+};
+
+// Static facts about one dictionary word, indexed by word ID
+struct WordFeatures {
+    double obscurity;               // calculateSolutionObscurityScore(word)
+    int32_t creates_prefix_id;      // slot of the best creates-prefix
+    uint8_t creates_prefix_len;     // the creates-prefix is always a suffix of the word
+    uint8_t obscure_suffix_length;  // 0 when no 2..MAX_PREFIX_LEN suffix is obscure
+    uint8_t flags;                  // WordFlag bits
+};
+
+// Bump whenever the rules that derive WordFeatures, prefix flags or the
+// solution postings from the word list change, so snapshots built by an
+// older build are rebuilt even though the table layout is the same
+const uint32_t LEXICON_FEATURES_VERSION = 1;
+
+// Sent by load_database as each loading phase completes
+struct LoadProgress {
+    std::string phase;      // "snapshot", "parse", "sort", "prefix cache", "features", "postings", "patterns"
+    size_t count;           // items produced by the phase (words, prefixes, patterns)
+    long long elapsed_ms;   // time since load_database started
+};
+
+using LoadProgressCallback = std::function<void(const LoadProgress&)>;
+
 struct WordRank {
     std::string word;
     std::string suffix;
@@ -43,17 +134,132 @@ struct WordRank {
     bool is_self_solving;
 };
 
+double calculateSolutionObscurityScore(const std::string& word);
+// Writes calculateSolutionObscurityScore(words[i]) to scores[i] for every word,
+// sharing one set of repeated-pair tables across the batch
+void calculateSolutionObscurityScores(const WordPool& words, double* scores);
+// The original map-based scoring; the fast path falls back to it for words
+// outside a..z and must match it bit for bit
+double calculateSolutionObscurityScoreReference(const std::string& word);
+
+// How getAIMove picks its word once there is a prefix to answer
+enum class AIEngine {
+    Heuristic,  // score every candidate, one-ply lookahead, shuffle within tiers
+    Search,     // iterative-deepening alpha-beta over the best-scored candidates
+    MonteCarlo  // UCT tree search with heuristic rollouts until a time budget runs out
+};
+
+struct SearchConfig {
+    int max_depth = 6;              // plies, counting the AI move itself
+    int time_budget_ms = 400;       // per move; 0 searches to max_depth
+    int branch_limit = 10;          // best-scored moves tried at each node
+    size_t table_entries = 1 << 18; // transposition table size, rounded down to a power of two
+};
+
+// Filled in by every search-engine move
+struct SearchStats {
+    uint64_t nodes = 0;
+    uint64_t table_hits = 0;
+    int depth_reached = 0;          // last fully searched depth
+    long long elapsed_ms = 0;
+    double nodes_per_second = 0.0;
+    std::string best_word;
+    double best_value = 0.0;
+};
+
+struct MonteCarloConfig {
+    // Per move, indexed by get_difficulty_level - 1; a tenth of the player's
+    // 12/10/7/5 second answer timer in main.qml
+    int budget_ms[4] = {1200, 1000, 700, 500};
+    uint64_t max_playouts = 0;      // 0 = until the budget runs out
+    double exploration = 1.4;       // UCT exploration constant
+    int branch_limit = 12;          // best-scored moves expanded per tree node
+    int rollout_plies = 8;          // rollouts still running after this are scored heuristically
+    int rollout_top_n = 3;          // rollouts pick among this many top (else regular) solves
+    size_t max_tree_nodes = 1 << 20;
+};
+
+// Filled in by every Monte Carlo move
+struct MonteCarloStats {
+    uint64_t playouts = 0;
+    size_t tree_nodes = 0;
+    int tree_depth = 0;
+    long long elapsed_ms = 0;
+    double playouts_per_second = 0.0;
+    std::string best_word;
+    uint32_t best_visits = 0;
+    double best_win_rate = 0.0;     // AI wins per visit through the chosen move
+};
+
+// One word played by either side. applyMove records what undoMove needs to
+// put the game back, so both directions are O(1) and allocation-free.
+struct GameMove {
+    uint32_t word;                  // dictionary word ID
+    bool by_ai;
+    int32_t solved_slot;            // solved-prefix slot the move set, -1 if none
+    int turns_since_heart_loss;     // the rest is the state before the move
+    int player_hearts;
+    int player_points;
+    uint64_t state_version;
+    uint8_t prefix_len;
+    char prefix[MAX_PREFIX_LEN];
+};
+
+// AI reply worked out ahead of time for one word the player is likely to submit
+struct SpeculativeReply {
+    std::string player_word;
+    std::string ai_word;                    // "" when the AI would have no move
+    std::vector<uint32_t> ai_top_moves;     // last_top_moves after the AI word
+    std::mt19937 rng_after;
+    std::vector<WordRank> top_moves;        // top solves for the prefix after the AI word
+    std::vector<WordRank> regular_moves;
+};
+
 class ShiritoriGame {
 private:
-    std::vector<std::string> dict;
-    std::vector<std::string> rev_dict;
+    WordPool dict;
     std::vector<std::string> patterns;
-    std::unordered_map<std::string, int> prefix_count_cache;
+    // Rare-prefix patterns as a flag per prefix slot, and one bit per word ID,
+    // laid out like used_bits, for the words whose creates-prefix is one
+    std::vector<uint8_t> pattern_slots;
+    std::vector<uint64_t> pattern_bits;
+    LexiconTable<PrefixRange> prefix_ranges;
+    LexiconTable<uint8_t> prefix_flags;
+    LexiconTable<WordFeatures> word_features;
+    std::unique_ptr<MappedFile> snapshot;
+    LoadProgressCallback load_progress;
+    std::chrono::high_resolution_clock::time_point load_start;
     
-    std::unordered_set<std::string> used_words;
-    std::unordered_set<std::string> exhausted_prefixes;
-    std::unordered_set<std::string> solved_suffixes;
-    std::vector<std::string> word_chain;
+    // One bit per dictionary word ID; dict is immutable after load_database
+    std::vector<uint64_t> used_bits;
+    // Live per-prefix-slot count of unused words, kept in step with used_bits
+    std::vector<uint32_t> prefix_unused;
+    // Live per-prefix-slot total length of the unused words
+    std::vector<uint32_t> prefix_unused_length;
+    // Per prefix slot, derived at load: the total length of its words
+    std::vector<uint32_t> prefix_total_length;
+    // The words of every prefix slot best first by one static key, with a live
+    // cursor on the first unused one. The slots of one prefix length split the
+    // dictionary between them, so each length has a block of words laid out
+    // like dict and a slot's list sits at its prefix range within that block.
+    struct PrefixPostings {
+        LexiconTable<uint32_t> words;       // MAX_PREFIX_LEN blocks of dict.size()
+        LexiconTable<uint32_t> rank;        // word ID -> position in key order
+        std::vector<uint32_t> cursor;       // per prefix slot, index into its block
+        std::vector<uint32_t> head;         // per prefix slot, the word there or NO_WORD
+    };
+    static const uint32_t NO_WORD = UINT32_MAX;
+    PrefixPostings solutions_by_obscurity;
+    PrefixPostings solutions_by_length;
+    // Prefix slots that had words and have run out of unused ones
+    std::vector<uint8_t> exhausted_prefixes;
+    // Prefixes already answered this game, one flag per prefix slot plus a
+    // last one for the empty prefix
+    std::vector<uint8_t> solved_prefixes;
+    // Word IDs played so far; reserved to the dictionary size by load_database
+    std::vector<uint32_t> word_chain;
+    // Moves made by the game-flow calls, so speculation can take them back
+    std::vector<GameMove> move_log;
     
     std::mt19937 rng;
     int turn_count;
@@ -63,31 +269,246 @@ private:
     std::bitset<26> letters_used;
     
     std::string current_prefix;
-    std::vector<std::string> last_top_moves;
+    // Word ids of the top moves the player can score a point with
+    std::vector<uint32_t> last_top_moves;
+
+    // A getTopAIMoves ranking stored column-wise by candidate; order lists the
+    // rows best first. WordRanks are only built for the rows a caller takes.
+    struct RankedMoves {
+        std::vector<uint32_t> ids;
+        std::vector<int32_t> solutions;         // unused words answering the creates-prefix
+        std::vector<int32_t> max_solution_len;
+        std::vector<double> obscurity;          // obscurity of the most obscure of them
+        std::vector<double> total;
+        std::vector<uint32_t> order;
+        size_t size() const { return order.size(); }
+        uint32_t id(size_t rank) const { return ids[order[rank]]; }
+        // Empties every column, with room reserved for the longest ranking so
+        // that filling them never allocates
+        void reset();
+    };
+    // Full sorted getTopAIMoves rankings: a fixed pool of entries, found by
+    // prefix slot and reused round-robin. Rankings depend on the used words and
+    // solved_prefixes only, so an entry is valid for one used_epoch; stale and
+    // evicted entries are ranked over in place so their storage is reused.
+    struct CachedRanking {
+        uint64_t epoch;
+        int32_t slot;                       // prefix slot held, -1 when free
+        RankedMoves ranked;
+    };
+    uint64_t used_epoch;
+    std::vector<CachedRanking> ranking_cache;
+    // Per prefix slot, 1 + the index of its ranking_cache entry, 0 for none
+    std::vector<uint16_t> ranking_cache_entry;
+    size_t next_ranking_entry;
+    // Ranking of the last prefix without a slot; those are not cached
+    RankedMoves uncached_ranking;
+    const RankedMoves* rank_top_moves(const std::string& prefix, const std::atomic<bool>* cancel);
+    bool rank_moves(const std::string& prefix, RankedMoves& ranked, size_t sorted, const std::atomic<bool>* cancel);
+    void fill_ranked_move(const RankedMoves& ranked, size_t rank, WordRank& wr) const;
+    // Stamp per prefix slot, so a ranking can take each creates-prefix once
+    std::vector<uint32_t> ranking_prefix_stamps;
+    uint32_t ranking_stamp;
+    // Per-turn scratch containers for getAIMove
+    ScratchArena scratch;
+
+    // Bumped by every committed change to the game state
+    uint64_t state_version;
+    uint64_t speculation_version;
+    std::vector<SpeculativeReply> speculative_replies;
+    int speculation_hits;
+    int speculation_misses;
+
+    // What a speculative turn changes besides its moves, so it can be rolled back
+    struct TurnCheckpoint {
+        size_t moves_played;
+        std::vector<uint32_t> last_top_moves;
+        std::mt19937 rng;
+    };
+    TurnCheckpoint save_checkpoint() const;
+    void restore_checkpoint(const TurnCheckpoint& checkpoint);
+    void commit_ai_word(uint32_t id);
+    int solved_slot(const std::string& prefix) const;
+    bool is_solved(const std::string& prefix) const;
+    // The creates-prefix of word `id`, and lookups on it through its prefix slot
+    std::string_view creates_prefix(uint32_t id) const;
+    PrefixRange creates_prefix_range(uint32_t id) const;
+    int creates_prefix_unused(uint32_t id) const;
+    bool creates_prefix_solved(uint32_t id) const;
+    // Longest unused solution length and highest unused solution obscurity
+    // (floored at 0) of word id's creates-prefix, read off the posting cursors
+    void creates_prefix_best(uint32_t id, int& max_solution_len, double* best_obscurity) const;
+    // getAIMove's ranking terms for count words, one output array per term
+    void score_candidates(const uint32_t* ids, size_t count, int32_t* solutions,
+        int32_t* max_solution_len, double* totals) const;
+    double score_candidate(uint32_t id) const;
+
+    // Words a read-only check treats as used on top of used_bits, so checks can
+    // run concurrently without writing shared state. Added words must be unused.
+    struct UsedOverlay {
+        static const int MAX_WORDS = 4;
+        uint32_t ids[MAX_WORDS];
+        int count = 0;
+        void add(uint32_t id) { ids[count++] = id; }
+    };
+    bool is_word_used(uint32_t id, const UsedOverlay& overlay) const;
+    int count_unused(const std::string& prefix, const UsedOverlay& overlay) const;
+    std::string find_valid_prefix(std::string_view word, int max_difficulty, const UsedOverlay& overlay) const;
+    bool lookahead_allows_reply(uint32_t id, double total_score, int player_difficulty, int ai_next_difficulty) const;
+    WorkStealingPool& worker_pool();
+    unsigned worker_threads;
+    std::unique_ptr<WorkStealingPool> pool;
+    void refresh_last_top_moves();
+    // Written by const scans too; see turnprofile.h
+    mutable TurnProfile turn_profile;
+
+    // Search engine (shiritorisearch.cpp)
+    struct SearchContext;
+    struct SearchEntry {
+        uint64_t key;
+        double value;
+        int32_t best_move;
+        int16_t depth;
+        uint8_t bound;
+        uint8_t generation;         // search_generation that stored it, 0 when cleared
+    };
+    AIEngine ai_engine;
+    SearchConfig search_config;
+    SearchStats search_stats;
+    std::vector<SearchEntry> search_table;
+    uint8_t search_generation;
+    std::atomic<bool> move_now;
+    int search_best_move(const std::string& prefix, const std::atomic<bool>* cancel);
+    void search_moves(const std::string& prefix, int limit, std::vector<std::pair<double, uint32_t>>& moves) const;
+    double search_node(SearchContext& ctx, bool ai_to_move, int depth, int ply,
+        double alpha, double beta, double last_score);
+
+    // Monte Carlo engine (shiritorimcts.cpp)
+    struct MonteCarloNode;
+    MonteCarloConfig monte_carlo_config;
+    MonteCarloStats monte_carlo_stats;
+    int monte_carlo_best_move(const std::string& prefix, const std::atomic<bool>* cancel);
+    // Rollout rankings skip the cache: every rollout ply follows a move, so
+    // each one would be a miss
+    RankedMoves rollout_ranking;
+    int rollout_move(const std::string& prefix, std::mt19937& rollout_rng);
     
+    int word_id(const std::string& word) const;
+    bool is_word_used(uint32_t id) const { return (used_bits[id >> 6] >> (id & 63)) & 1; }
+    void mark_used(uint32_t id);
+    void unmark_used(uint32_t id);
+    void reset_prefix_counters();
+    bool build_lexicon(const std::string& dict_file);
+    void report_load_progress(const char* phase, size_t count) const;
+    void build_static_features();
+    void build_prefix_summaries();
+    void build_pattern_tables();
+    void collect_pattern_words(PrefixRange range, ScratchVector<uint32_t>& out) const;
+    void build_prefix_postings();
+    void build_postings(PrefixPostings& postings, const std::vector<uint32_t>& order);
+    // Keep a slot's cursor on its first unused word as its words are used and freed
+    void advance_posting(PrefixPostings& postings, int len, int slot);
+    void rewind_posting(PrefixPostings& postings, int len, int slot, uint32_t id);
+    bool load_snapshot(const std::string& path, bool check_source, uint64_t source_checksum);
+    bool save_snapshot(const std::string& path, uint64_t source_checksum) const;
+    uint32_t count_used(PrefixRange range) const;
+    PrefixRange prefix_range(const std::string& prefix) const;
+    PrefixRange prefix_range(const char* prefix, int len) const;
     bool has_unused_words(const std::string& prefix) const;
-    std::string find_valid_prefix(const std::string& word, int max_difficulty) const;
-    bool word_ends_with_blacklisted_suffix(const std::string& word) const;
+    std::string find_valid_prefix(std::string_view word, int max_difficulty) const;
+    bool word_ends_with_blacklisted_suffix(std::string_view word) const;
     bool is_prefix_blacklisted(const std::string& prefix) const;
     bool is_prefix_self_solving(const std::string& prefix) const;
 
 public:
     ShiritoriGame();
     
-    bool load_database(const std::string& dict_file, const std::string& patterns_file);
+    // Safe to call off the GUI thread on a game no other thread is using;
+    // `progress` is invoked on the loading thread
+    bool load_database(const std::string& dict_file, const std::string& patterns_file,
+        LoadProgressCallback progress = nullptr);
     void reset_game();
+    // Reseeds the engine's rng, making AI choices reproducible
+    void setSeed(uint32_t seed) { rng.seed(seed); }
     
     bool is_valid_word(const std::string& word);
     bool is_used(const std::string& word);
     
     std::string getCurrentPrefix() const;
     int getCurrentDifficulty() const;
+    // True for the prefixes listed in the patterns file
+    bool isRarePrefix(const std::string& prefix) const;
     std::vector<std::string> getTopMoves(const std::string& prefix) const;
-    std::vector<WordRank> getTopAIMoves(const std::string& prefix, int top_n = TOP_MOVES_TO_SHOW);
+    // `cancel` may be raised from another thread; a cancelled ranking returns
+    // no moves, a cancelled getAIMove returns "" before it commits anything
+    std::vector<WordRank> getTopAIMoves(const std::string& prefix, int top_n = TOP_MOVES_TO_SHOW,
+        const std::atomic<bool>* cancel = nullptr);
     std::vector<WordRank> getRegularSolves(const std::string& prefix, int max_n = 5);
+    // The same into the first rows of `moves`, returning how many were filled.
+    // Rows are overwritten in place and the vector never shrinks, so a buffer
+    // reused across turns keeps its strings' storage and stops allocating once
+    // it has held that many rows of words that long.
+    size_t getTopAIMoves(const std::string& prefix, int top_n, std::vector<WordRank>& moves,
+        const std::atomic<bool>* cancel = nullptr);
+    size_t getRegularSolves(const std::string& prefix, int max_n, std::vector<WordRank>& moves);
     std::string getRandomStartWord();
     void processPlayerWord(const std::string& word);
-    std::string getAIMove();
+    // The word played, a view into the lexicon valid until the next
+    // load_database; empty when the AI has no move. With the heuristic engine
+    // a turn allocates nothing once the game's scratch storage has warmed up.
+    std::string_view getAIMove(const std::atomic<bool>* cancel = nullptr);
+
+    // Plays an unused word for either side: used words, prefix counters, the
+    // chain, turn counters, solved prefixes, points and hearts, and, after an
+    // AI move, the current prefix. Moves must be undone newest first. Neither
+    // call allocates, so a search can walk any number of positions on one game.
+    GameMove applyMove(uint32_t word, bool by_ai);
+    void undoMove(const GameMove& move);
+    // Hash of every field applyMove and undoMove change, so a self-check can
+    // tell whether an undo restored the game; used_epoch only moves forward
+    // and is left out
+    uint64_t stateDigest() const;
+    // Whether every prefix slot's posting cursors sit on its first unused word,
+    // found by scanning its lists; for self-checks
+    bool postingCursorsMatchScan() const;
+    // Word IDs are indices into the sorted dictionary; getWordId returns -1
+    // for words outside it
+    size_t getDictionarySize() const { return dict.size(); }
+    // Views into the lexicon, valid until the next load_database
+    std::string_view getWord(uint32_t id) const { return dict[id]; }
+    int getWordId(const std::string& word) const;
+
+    // Plays each likely player word against a rolled-back copy of the current
+    // turn and keeps the AI's reply. Meant for the player's think time.
+    void speculateReplies(const std::vector<std::string>& player_words,
+        const std::atomic<bool>* cancel = nullptr);
+    // Call right after processPlayerWord: when that word was speculated on,
+    // commits the stored AI reply exactly as getAIMove would have and returns
+    // it; otherwise returns nullptr and the caller runs getAIMove
+    const SpeculativeReply* playSpeculatedAIMove();
+    int getSpeculationHits() const { return speculation_hits; }
+    int getSpeculationMisses() const { return speculation_misses; }
+
+    // Threads for getAIMove's candidate lookahead; 0 uses every hardware thread
+    void setWorkerThreads(unsigned threads);
+
+    void setAIEngine(AIEngine engine) { ai_engine = engine; }
+    AIEngine getAIEngine() const { return ai_engine; }
+    void setSearchConfig(const SearchConfig& config);
+    const SearchConfig& getSearchConfig() const { return search_config; }
+    const SearchStats& getLastSearchStats() const { return search_stats; }
+    void setMonteCarloConfig(const MonteCarloConfig& config);
+    const MonteCarloConfig& getMonteCarloConfig() const { return monte_carlo_config; }
+    const MonteCarloStats& getLastMonteCarloStats() const { return monte_carlo_stats; }
+    // Phase timings and scan counters since the last reset; all zero unless
+    // built with SHIRITORI_PROFILING
+    const TurnProfile& getTurnProfile() const { return turn_profile; }
+    void resetTurnProfile() { turn_profile = TurnProfile(); }
+    // Thread-safe: makes a running search or Monte Carlo move stop and play the
+    // best move found so far. The request holds until clearMoveNow, which the
+    // caller issues before dispatching the AI turn it is meant for.
+    void requestMoveNow() { move_now.store(true); }
+    void clearMoveNow() { move_now.store(false); }
     bool wasTopSolve(const std::string& word) const;
     std::string getNewPrefix(const std::string& word, int difficulty) const;
     int countSolutions(const std::string& prefix) const;
@@ -95,7 +516,7 @@ public:
     // Expose player getters publicly so GameController can read them
     int getPlayerHearts() const { return player_hearts; }
     int getPlayerPoints() const { return player_points; }
-    const std::vector<std::string>& getWordChain() const { return word_chain; }
+    std::vector<std::string> getWordChain() const;
     void losePlayerHeart();
 };
 
@@ -0,0 +1,231 @@
+#include "shiritorigame.h"
+#include "tracing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// UCT Monte Carlo tree search behind getAIMove. Tree nodes are the best
+// score_candidate moves of each position; below the tree, rollouts play the
+// same picks the trainer shows the player (the top solves, else the regular
+// solves). A playout is an AI win when the player is left without a prefix.
+// Since a one-letter prefix is nearly always left, most rollouts stop at
+// rollout_plies instead. They are scored by how hard each side made the
+// other's prefixes: a logistic of the AI's mean score_candidate total over
+// the playout's moves minus the player's. Scoring the side to move alone
+// left the result to the parity of the cut-off ply.
+
+struct ShiritoriGame::MonteCarloNode {
+  uint32_t word;          // move leading here
+  double score;           // score_candidate total of `word`, clamped
+  bool ai_moved;          // whether the AI played `word`
+  bool expanded;
+  bool terminal;          // the side to move has no prefix left
+  double terminal_value;  // AI result of a terminal node
+  uint32_t first_child;   // children are stored contiguously
+  uint32_t child_count;
+  uint32_t visits;
+  double wins;            // results from the point of view of whoever played `word`
+};
+
+void ShiritoriGame::setMonteCarloConfig(const MonteCarloConfig& config) {
+  monte_carlo_config = config;
+  for (int& budget : monte_carlo_config.budget_ms) budget = std::max(0, budget);
+  monte_carlo_config.branch_limit = std::max(1, monte_carlo_config.branch_limit);
+  monte_carlo_config.rollout_plies = std::max(0, monte_carlo_config.rollout_plies);
+  monte_carlo_config.rollout_top_n = std::max(1, monte_carlo_config.rollout_top_n);
+  monte_carlo_config.max_tree_nodes = std::max<size_t>(1, monte_carlo_config.max_tree_nodes);
+}
+
+namespace {
+
+// Mean totals are around 10000 and a one-answer creates-prefix outscores a
+// two-answer one by 5000, so this scale keeps cut-off values off 0 and 1
+const double ROLLOUT_SCORE_SCALE = 2000.0;
+const double ROLLOUT_SCORE_LIMIT = 1e6;
+
+inline double clamp_score(double score) {
+  return std::max(-ROLLOUT_SCORE_LIMIT, std::min(ROLLOUT_SCORE_LIMIT, score));
+}
+
+} // namespace
+
+// One rollout step: a random pick among the top solves, falling back to the
+// regular solves when no move is worth ranking; -1 if neither has a word.
+// getRegularSolves takes the first unused words of the range, so a pick among
+// those is the same pick.
+int ShiritoriGame::rollout_move(const std::string& prefix, std::mt19937& rollout_rng) {
+  const size_t n = static_cast<size_t>(monte_carlo_config.rollout_top_n);
+  rank_moves(prefix, rollout_ranking, n, nullptr);
+  if (rollout_ranking.size() > 0) {
+    std::uniform_int_distribution<size_t> pick(0, std::min(n, rollout_ranking.size()) - 1);
+    return static_cast<int>(rollout_ranking.id(pick(rollout_rng)));
+  }
+
+  const PrefixRange range = prefix_range(prefix);
+  size_t unused = 0;
+  for (uint32_t i = range.begin; i < range.end && unused < n; ++i) unused += !is_word_used(i);
+  if (unused == 0) return -1;
+  size_t skip = std::uniform_int_distribution<size_t>(0, unused - 1)(rollout_rng);
+  for (uint32_t i = range.begin; i < range.end; ++i) {
+    if (is_word_used(i)) continue;
+    if (skip-- == 0) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+// Runs playouts from the AI's side of `prefix` until the budget for the
+// current difficulty, max_playouts, `cancel` or requestMoveNow stops it, and
+// returns the most visited root move (-1 if there is none)
+int ShiritoriGame::monte_carlo_best_move(const std::string& prefix, const std::atomic<bool>* cancel) {
+  TRACE_SPAN("ShiritoriGame::monte_carlo_best_move");
+  const auto start = std::chrono::steady_clock::now();
+  const MonteCarloConfig& config = monte_carlo_config;
+  monte_carlo_stats = MonteCarloStats();
+
+  const int difficulty = get_difficulty_level(turns_since_heart_loss);
+  const auto deadline = start + std::chrono::milliseconds(config.budget_ms[difficulty - 1]);
+  std::mt19937 rollout_rng(rng());
+
+  std::vector<MonteCarloNode> tree;
+  tree.reserve(std::min<size_t>(config.max_tree_nodes, 1 << 16));
+  std::vector<std::pair<double, uint32_t>> moves;
+
+  auto expand = [&](uint32_t index, const std::string& node_prefix) {
+    search_moves(node_prefix, config.branch_limit, moves);
+    const bool ai_moves = !tree[index].ai_moved;
+    tree[index].expanded = true;
+    tree[index].first_child = static_cast<uint32_t>(tree.size());
+    tree[index].child_count = static_cast<uint32_t>(moves.size());
+    for (const auto& move : moves) {
+      tree.push_back({move.second, clamp_score(move.first), ai_moves, false, false, 0.0, 0, 0, 0, 0.0});
+    }
+  };
+
+  // The root stands for the player's last word, so its children are AI moves
+  tree.push_back({0, 0.0, false, false, false, 0.0, 0, 0, 0, 0.0});
+  expand(0, prefix);
+  if (tree[0].child_count == 0) return -1;
+
+  std::vector<uint32_t> path;
+  std::vector<GameMove> played;
+  while (tree[0].child_count > 1) {
+    if (is_cancelled(cancel)) return -1;
+    if (move_now.load(std::memory_order_relaxed)) break;
+    if (config.max_playouts > 0 && monte_carlo_stats.playouts >= config.max_playouts) break;
+    if (config.max_playouts == 0 && std::chrono::steady_clock::now() >= deadline) break;
+
+    path.assign(1, 0);
+    played.clear();
+    double result = 0.5;
+    bool decided = false;
+
+    // Selection and expansion
+    uint32_t node = 0;
+    for (;;) {
+      if (!tree[node].expanded) {
+        if (tree[node].visits == 0 || tree.size() >= config.max_tree_nodes) break;
+        const std::string node_prefix = find_valid_prefix(dict[tree[node].word], get_difficulty_level(turns_since_heart_loss));
+        if (node_prefix.empty()) {
+          tree[node].expanded = true;
+          tree[node].terminal = true;
+          // A stuck AI restarts the chain with a random word, which counts as a draw
+          tree[node].terminal_value = tree[node].ai_moved ? 1.0 : 0.5;
+        } else {
+          expand(node, node_prefix);
+        }
+      }
+      if (tree[node].terminal) {
+        result = tree[node].terminal_value;
+        decided = true;
+        break;
+      }
+
+      // UCT, trying unvisited children first in score order
+      const MonteCarloNode& parent = tree[node];
+      const double log_visits = std::log(static_cast<double>(std::max(parent.visits, 1u)));
+      uint32_t best = parent.first_child;
+      double best_value = -1.0;
+      for (uint32_t c = parent.first_child; c < parent.first_child + parent.child_count; ++c) {
+        const MonteCarloNode& child = tree[c];
+        if (child.visits == 0) {
+          best = c;
+          break;
+        }
+        double value = child.wins / child.visits + config.exploration * std::sqrt(log_visits / child.visits);
+        if (value > best_value) {
+          best_value = value;
+          best = c;
+        }
+      }
+
+      node = best;
+      path.push_back(node);
+      played.push_back(applyMove(tree[node].word, tree[node].ai_moved));
+      monte_carlo_stats.tree_depth = std::max(monte_carlo_stats.tree_depth, static_cast<int>(path.size()) - 1);
+    }
+
+    // Rollout from the leaf
+    if (!decided) {
+      bool ai_to_move = !tree[node].ai_moved;
+      // Move totals per side over the whole playout, AI first
+      double score_sum[2] = {0.0, 0.0};
+      int score_count[2] = {0, 0};
+      for (size_t k = 1; k < path.size(); ++k) {
+        const MonteCarloNode& move = tree[path[k]];
+        score_sum[move.ai_moved ? 0 : 1] += move.score;
+        ++score_count[move.ai_moved ? 0 : 1];
+      }
+      for (int ply = 0; ply <= config.rollout_plies; ++ply) {
+        const std::string rollout_prefix =
+            find_valid_prefix(dict[word_chain.back()], get_difficulty_level(turns_since_heart_loss));
+        if (rollout_prefix.empty()) {
+          result = ai_to_move ? 0.5 : 1.0;
+          break;
+        }
+        if (ply == config.rollout_plies) {
+          const double ai_mean = score_count[0] ? score_sum[0] / score_count[0] : 0.0;
+          const double player_mean = score_count[1] ? score_sum[1] / score_count[1] : 0.0;
+          result = 1.0 / (1.0 + std::exp((player_mean - ai_mean) / ROLLOUT_SCORE_SCALE));
+          break;
+        }
+        int id = rollout_move(rollout_prefix, rollout_rng);
+        if (id < 0) break;
+        score_sum[ai_to_move ? 0 : 1] += clamp_score(score_candidate(id));
+        ++score_count[ai_to_move ? 0 : 1];
+        played.push_back(applyMove(id, ai_to_move));
+        ai_to_move = !ai_to_move;
+      }
+    }
+
+    for (uint32_t index : path) {
+      MonteCarloNode& visited = tree[index];
+      ++visited.visits;
+      visited.wins += visited.ai_moved ? result : 1.0 - result;
+    }
+    for (auto it = played.rbegin(); it != played.rend(); ++it) undoMove(*it);
+    ++monte_carlo_stats.playouts;
+  }
+
+  // Most visited root move, the better win rate breaking ties
+  const MonteCarloNode& root = tree[0];
+  uint32_t best = root.first_child;
+  for (uint32_t c = root.first_child + 1; c < root.first_child + root.child_count; ++c) {
+    const MonteCarloNode& child = tree[c];
+    const MonteCarloNode& current = tree[best];
+    if (child.visits > current.visits ||
+        (child.visits == current.visits && child.visits > 0 &&
+         child.wins / child.visits > current.wins / current.visits)) {
+      best = c;
+    }
+  }
+
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  monte_carlo_stats.tree_nodes = tree.size();
+  monte_carlo_stats.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+  monte_carlo_stats.playouts_per_second = seconds > 0.0 ? monte_carlo_stats.playouts / seconds : 0.0;
+  monte_carlo_stats.best_word = dict[tree[best].word];
+  monte_carlo_stats.best_visits = tree[best].visits;
+  monte_carlo_stats.best_win_rate = tree[best].visits ? tree[best].wins / tree[best].visits : 0.0;
+  return static_cast<int>(tree[best].word);
+}
@@ -0,0 +1,272 @@
+#include "shiritorigame.h"
+#include "tracing.h"
+#include <algorithm>
+#include <chrono>
+
+// Negamax alpha-beta over the game tree behind getAIMove, played out on the
+// game itself with applyMove/undoMove. Values are from the side to move; a
+// leaf is worth minus the score_candidate total of the move that reached it,
+// so a one-ply search picks what the heuristic engine ranks first and deeper
+// searches correct it with the replies it leaves open.
+
+namespace {
+
+// Beats any heuristic total; shortened by ply so quicker wins rank higher
+const double WIN_VALUE = 1e7;
+const double WIN_BOUND = WIN_VALUE - 1000.0;
+const double INFINITE_VALUE = 2 * WIN_VALUE;
+// score_candidate totals are clamped below win values (a one-letter
+// creates-prefix makes its obscurity term overflow to ~1e20)
+const double SCORE_LIMIT = 1e6;
+
+enum SearchBound : uint8_t {
+  BOUND_EXACT,
+  BOUND_LOWER,
+  BOUND_UPPER
+};
+
+inline uint64_t mix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// Zobrist keys for the used-word set, derived from the word ID rather than stored
+inline uint64_t word_key(uint32_t id) {
+  return mix64(id);
+}
+
+// Solved prefix slots change the leaf scores, so they are keyed too, apart
+// from the word IDs
+inline uint64_t solved_key(size_t slot) {
+  return mix64(~static_cast<uint64_t>(slot));
+}
+
+inline uint64_t move_key(const GameMove& move) {
+  return word_key(move.word) ^ (move.solved_slot >= 0 ? solved_key(move.solved_slot) : 0);
+}
+
+// The prefix to answer is not implied by the used set, and the difficulty of
+// every later turn follows from the turn counter until it saturates
+inline uint64_t position_key(uint64_t used_hash, const std::string& prefix, int turns, bool ai_to_move) {
+  uint64_t key = mix64(std::min(turns, MAX_DIFFICULTY_STEP) * 2 + (ai_to_move ? 1 : 0));
+  for (char c : prefix) key = mix64(key ^ static_cast<unsigned char>(c));
+  return key ^ used_hash;
+}
+
+// Win values are stored relative to the node so they stay valid at any ply
+inline double to_table(double value, int ply) {
+  if (value > WIN_BOUND) return value + ply;
+  if (value < -WIN_BOUND) return value - ply;
+  return value;
+}
+
+inline double from_table(double value, int ply) {
+  if (value > WIN_BOUND) return value - ply;
+  if (value < -WIN_BOUND) return value + ply;
+  return value;
+}
+
+} // namespace
+
+struct ShiritoriGame::SearchContext {
+  const std::atomic<bool>* cancel;
+  std::chrono::steady_clock::time_point deadline;
+  bool has_deadline;
+  bool stopped;
+  uint64_t used_hash;
+  uint64_t nodes;
+  uint64_t table_hits;
+  size_t table_mask;
+  // One move list per ply, so the recursion does not allocate
+  std::vector<std::vector<std::pair<double, uint32_t>>> moves;
+};
+
+void ShiritoriGame::setSearchConfig(const SearchConfig& config) {
+  search_config = config;
+  search_config.max_depth = std::max(1, search_config.max_depth);
+  search_config.time_budget_ms = std::max(0, search_config.time_budget_ms);
+  search_config.table_entries = std::max<size_t>(1, search_config.table_entries);
+}
+
+// Unused words answering `prefix`, best score_candidate total first, cut to `limit`
+void ShiritoriGame::search_moves(const std::string& prefix, int limit,
+    std::vector<std::pair<double, uint32_t>>& moves) const {
+  moves.clear();
+  PrefixRange range = prefix_range(prefix);
+  for (uint32_t i = range.begin; i < range.end; ++i) {
+    if (!is_word_used(i)) {
+      moves.push_back({std::max(-SCORE_LIMIT, std::min(SCORE_LIMIT, score_candidate(i))), i});
+    }
+  }
+
+  auto better = [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) {
+    if (a.first != b.first) return a.first > b.first;
+    return a.second < b.second;
+  };
+  if (limit > 0 && moves.size() > static_cast<size_t>(limit)) {
+    std::partial_sort(moves.begin(), moves.begin() + limit, moves.end(), better);
+    moves.resize(limit);
+  } else {
+    std::sort(moves.begin(), moves.end(), better);
+  }
+}
+
+double ShiritoriGame::search_node(SearchContext& ctx, bool ai_to_move, int depth, int ply,
+    double alpha, double beta, double last_score) {
+  if ((++ctx.nodes & 255) == 0) {
+    if (is_cancelled(ctx.cancel) || move_now.load(std::memory_order_relaxed) ||
+        (ctx.has_deadline && std::chrono::steady_clock::now() >= ctx.deadline)) {
+      ctx.stopped = true;
+    }
+  }
+  if (ctx.stopped) return 0.0;
+
+  std::string prefix = find_valid_prefix(dict[word_chain.back()], get_difficulty_level(turns_since_heart_loss));
+  if (prefix.empty()) {
+    // A stuck AI restarts the chain with a random word; a stuck player loses
+    return ai_to_move ? 0.0 : -(WIN_VALUE - ply);
+  }
+  if (depth == 0) return -last_score;
+
+  const double alpha_orig = alpha;
+  const uint64_t key = position_key(ctx.used_hash, prefix, turns_since_heart_loss, ai_to_move);
+  SearchEntry& entry = search_table[key & ctx.table_mask];
+  int32_t hash_move = -1;
+  if (entry.key == key) {
+    hash_move = entry.best_move;
+    // Entries from earlier searches only order moves, since their values may
+    // come from a different branch limit
+    if (entry.generation == search_generation && entry.depth >= depth) {
+      ++ctx.table_hits;
+      double value = from_table(entry.value, ply);
+      if (entry.bound == BOUND_EXACT) return value;
+      if (entry.bound == BOUND_LOWER) alpha = std::max(alpha, value);
+      else beta = std::min(beta, value);
+      if (alpha >= beta) return value;
+    }
+  }
+
+  std::vector<std::pair<double, uint32_t>>& moves = ctx.moves[ply];
+  search_moves(prefix, search_config.branch_limit, moves);
+  if (hash_move >= 0) {
+    for (size_t i = 1; i < moves.size(); ++i) {
+      if (moves[i].second == static_cast<uint32_t>(hash_move)) {
+        std::rotate(moves.begin(), moves.begin() + i, moves.begin() + i + 1);
+        break;
+      }
+    }
+  }
+
+  double best = -INFINITE_VALUE;
+  int32_t best_move = -1;
+  for (const auto& move : moves) {
+    const uint32_t id = move.second;
+    const GameMove played = applyMove(id, ai_to_move);
+    ctx.used_hash ^= move_key(played);
+    double value = -search_node(ctx, !ai_to_move, depth - 1, ply + 1, -beta, -alpha, move.first);
+    ctx.used_hash ^= move_key(played);
+    undoMove(played);
+    if (ctx.stopped) return 0.0;
+
+    if (value > best) {
+      best = value;
+      best_move = static_cast<int32_t>(id);
+    }
+    alpha = std::max(alpha, value);
+    if (alpha >= beta) break;
+  }
+
+  entry.key = key;
+  entry.value = to_table(best, ply);
+  entry.best_move = best_move;
+  entry.depth = static_cast<int16_t>(depth);
+  entry.bound = best <= alpha_orig ? BOUND_UPPER : (best >= beta ? BOUND_LOWER : BOUND_EXACT);
+  entry.generation = search_generation;
+  return best;
+}
+
+// Iterative deepening from the AI's side of `prefix`. Stops at max_depth, the
+// time budget, `cancel` or requestMoveNow, and returns the best move of the last depth it
+// finished (the best-scored move if not even depth 1 finished), -1 if none.
+int ShiritoriGame::search_best_move(const std::string& prefix, const std::atomic<bool>* cancel) {
+  TRACE_SPAN("ShiritoriGame::search_best_move");
+  const auto start = std::chrono::steady_clock::now();
+  search_stats = SearchStats();
+
+  size_t entries = 1;
+  while (entries * 2 <= search_config.table_entries) entries *= 2;
+  if (search_table.size() != entries) search_table.assign(entries, SearchEntry());
+  // Generation 0 marks cleared entries. When the 8-bit counter wraps, entries
+  // 255 searches old would look current again, so the table is cleared instead.
+  if (++search_generation == 0) {
+    std::fill(search_table.begin(), search_table.end(), SearchEntry());
+    search_generation = 1;
+  }
+
+  SearchContext ctx;
+  ctx.cancel = cancel;
+  ctx.has_deadline = search_config.time_budget_ms > 0;
+  ctx.deadline = start + std::chrono::milliseconds(search_config.time_budget_ms);
+  ctx.stopped = false;
+  ctx.used_hash = 0;
+  ctx.nodes = 0;
+  ctx.table_hits = 0;
+  ctx.table_mask = entries - 1;
+  ctx.moves.resize(search_config.max_depth + 1);
+  for (size_t block = 0; block < used_bits.size(); ++block) {
+    if (!used_bits[block]) continue;
+    for (uint32_t bit = 0; bit < 64; ++bit) {
+      if ((used_bits[block] >> bit) & 1) ctx.used_hash ^= word_key(static_cast<uint32_t>(block * 64 + bit));
+    }
+  }
+  for (size_t slot = 0; slot < solved_prefixes.size(); ++slot) {
+    if (solved_prefixes[slot]) ctx.used_hash ^= solved_key(slot);
+  }
+
+  std::vector<std::pair<double, uint32_t>> root_moves;
+  search_moves(prefix, search_config.branch_limit, root_moves);
+  if (root_moves.empty()) return -1;
+
+  uint32_t best_move = root_moves[0].second;
+  double best_value = root_moves[0].first;
+  for (int depth = 1; depth <= search_config.max_depth; ++depth) {
+    double alpha = -INFINITE_VALUE;
+    size_t iteration_best = 0;
+    for (size_t i = 0; i < root_moves.size(); ++i) {
+      const uint32_t id = root_moves[i].second;
+      const GameMove played = applyMove(id, true);
+      ctx.used_hash ^= move_key(played);
+      double value = -search_node(ctx, false, depth - 1, 1, -INFINITE_VALUE, -alpha, root_moves[i].first);
+      ctx.used_hash ^= move_key(played);
+      undoMove(played);
+      if (ctx.stopped) break;
+
+      if (value > alpha) {
+        alpha = value;
+        iteration_best = i;
+      }
+    }
+    if (ctx.stopped) break;
+
+    best_move = root_moves[iteration_best].second;
+    best_value = alpha;
+    search_stats.depth_reached = depth;
+
+    // Search the best line first at the next depth
+    std::rotate(root_moves.begin(), root_moves.begin() + iteration_best,
+        root_moves.begin() + iteration_best + 1);
+    if (best_value > WIN_BOUND) break;
+  }
+
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  search_stats.nodes = ctx.nodes;
+  search_stats.table_hits = ctx.table_hits;
+  search_stats.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+  search_stats.nodes_per_second = seconds > 0.0 ? ctx.nodes / seconds : 0.0;
+  search_stats.best_word = dict[best_move];
+  search_stats.best_value = best_value;
+  return static_cast<int>(best_move);
+}
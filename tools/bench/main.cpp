@@ -0,0 +1,612 @@
+// Microbenchmarks for the engine hot paths on reproducible fixtures: a
+// dictionary generated from a fixed seed (or --dictionary), the repo's
+// pattern file, and used-word sets pre-played with applyMove.
+//
+//   bench <Dictionary dir> [options]
+//     --dictionary FILE   benchmark this dictionary instead of the synthetic one
+//     --words N           synthetic dictionary size (120000)
+//     --seed N            seed for the dictionary, fixtures and probes (1)
+//     --samples N         timed samples per benchmark; the median and the
+//                         fastest sample are reported (5)
+//     --min-ms N          shortest sample (50)
+//     --json FILE         write the results as JSON
+//     --compare FILE      compare with a file written by --json; exits 1 when
+//                         any benchmark's fastest sample slowed down by more
+//                         than --threshold
+//     --threshold PCT     allowed slowdown in percent (20); same-binary runs
+//                         differ by up to ~20% on a desktop, more on shared hosts
+//
+// The synthetic dictionary is an order-2 letter model of the words in
+// solved_rare_prefix.txt, written to bench_dictionary.txt in the working
+// directory. has_unused_words and find_valid_prefix are private and are
+// measured through their public wrappers, countSolutions and getNewPrefix.
+// Before timing anything the bench checks that the fast obscurity scoring
+// matches the reference bit for bit, that undoMove restores the state
+// applyMove changed and that the posting cursors agree with a scan, over
+// random walks of moves; a mismatch exits 1.
+// Each result also counts the global heap allocations made inside its timed
+// sections (allocs/op), through a counting operator new. The bench exits 1 if
+// any benchmark in ALLOCATION_FREE allocates. Those run after an untimed
+// warm-up pass, the rankings into reused WordRank buffers and getAIMove with
+// the heuristic engine. Loading and the reference scoring do allocate.
+
+#include "shiritorigame.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <unordered_map>
+#include <unordered_set>
+
+// Every global operator new in the process; see the replacements below main
+std::atomic<uint64_t> heap_allocations(0);
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchResult {
+  std::string name;
+  std::string fixture;
+  uint64_t ops;
+  double ns_per_op;       // median over the samples, shown for reference
+  double min_ns_per_op;   // fastest sample, what --json baselines and --compare use
+  double allocs_per_op;   // global heap allocations inside the timed sections
+};
+
+// Accumulates only the time and allocations between start and stop, so passes
+// can leave setup untimed
+struct Stopwatch {
+  Clock::time_point started;
+  uint64_t allocations_at_start = 0;
+  double ns = 0.0;
+  uint64_t allocations = 0;
+  void start() {
+    allocations_at_start = heap_allocations.load(std::memory_order_relaxed);
+    started = Clock::now();
+  }
+  void stop() {
+    ns += std::chrono::duration<double, std::nano>(Clock::now() - started).count();
+    allocations += heap_allocations.load(std::memory_order_relaxed) - allocations_at_start;
+  }
+};
+
+// Benchmarks whose timed sections must not touch the heap
+const char* const ALLOCATION_FREE[] = {
+  "calculateSolutionObscurityScore", "calculateSolutionObscurityScores", "countSolutions", "getNewPrefix",
+  "getRegularSolves", "getTopAIMoves", "getTopAIMoves_cached", "getAIMove"
+};
+
+int samples = 5;
+int min_ms = 50;
+std::vector<BenchResult> results;
+// Keeps the optimizer from dropping the measured calls
+volatile size_t sink = 0;
+
+// Repeats `pass` (which returns its op count) until a sample reaches min_ms
+template <typename Pass>
+void measure(const std::string& name, const std::string& fixture, Pass pass, int sample_count = samples,
+    bool repeat = true) {
+  std::vector<double> per_op;
+  uint64_t total_ops = 0;
+  uint64_t total_allocations = 0;
+  for (int s = 0; s < sample_count; ++s) {
+    Stopwatch watch;
+    uint64_t ops = 0;
+    do {
+      ops += pass(watch);
+    } while (repeat && watch.ns < min_ms * 1e6);
+    total_ops += ops;
+    total_allocations += watch.allocations;
+    per_op.push_back(ops ? watch.ns / ops : 0.0);
+  }
+  std::sort(per_op.begin(), per_op.end());
+  results.push_back({name, fixture, total_ops, per_op[per_op.size() / 2], per_op.front(),
+                     total_ops ? static_cast<double>(total_allocations) / total_ops : 0.0});
+
+  const BenchResult& r = results.back();
+  std::cout << std::left << std::setw(42) << r.name << std::setw(12) << r.fixture << std::right
+            << std::fixed << std::setprecision(1) << std::setw(14) << r.ns_per_op << " ns/op"
+            << std::setw(14) << r.min_ns_per_op << " min" << std::setprecision(2) << std::setw(10)
+            << r.allocs_per_op << " allocs/op  " << r.ops << " ops\n" << std::flush;
+}
+
+std::string lowercase_letters(const std::string& raw) {
+  std::string word;
+  for (char c : raw) {
+    if (std::isalpha(static_cast<unsigned char>(c))) word += std::tolower(static_cast<unsigned char>(c));
+  }
+  return word;
+}
+
+// Order-2 letter model of the corpus words; picks are taken straight from
+// mt19937 output so the file is the same on every platform
+bool write_synthetic_dictionary(const std::string& corpus_file, const std::string& out_file,
+    size_t count, uint32_t seed) {
+  std::ifstream corpus(corpus_file);
+  if (!corpus) return false;
+
+  std::vector<std::string> words;
+  std::string line;
+  while (std::getline(corpus, line)) {
+    if (line.rfind("- ", 0) != 0) continue;
+    std::string word = lowercase_letters(line.substr(2));
+    if (word.length() >= 2) words.push_back(word);
+  }
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+  if (words.empty()) return false;
+
+  // Context "^^" starts a word; letter 26 ends it
+  std::unordered_map<std::string, std::array<uint32_t, 27>> model;
+  for (const auto& word : words) {
+    std::string s = "^^" + word;
+    for (size_t i = 2; i <= s.length(); ++i) {
+      auto& counts = model.emplace(s.substr(i - 2, 2), std::array<uint32_t, 27>()).first->second;
+      ++counts[i < s.length() ? s[i] - 'a' : 26];
+    }
+  }
+
+  std::unordered_set<std::string> seen(words.begin(), words.end());
+  std::vector<std::string> out = words;
+  std::mt19937 rng(seed);
+  for (size_t attempts = 0; out.size() < count && attempts < count * 50; ++attempts) {
+    std::string s = "^^";
+    while (s.length() < 20) {
+      const auto& counts = model[s.substr(s.length() - 2)];
+      uint32_t total = 0;
+      for (uint32_t c : counts) total += c;
+      if (total == 0) break;
+      uint32_t r = rng() % total;
+      int letter = 0;
+      while (r >= counts[letter]) r -= counts[letter++];
+      if (letter == 26) break;
+      s += static_cast<char>('a' + letter);
+    }
+    std::string word = s.substr(2);
+    if (word.length() >= 2 && word.length() <= 18 && seen.insert(word).second) out.push_back(word);
+  }
+
+  std::ofstream file(out_file, std::ios::trunc);
+  for (const auto& word : out) file << word << "\n";
+  return static_cast<bool>(file);
+}
+
+// Plays `used` random unused words, alternating sides, from a fixed seed
+void prepare_fixture(ShiritoriGame& game, size_t used, uint32_t seed) {
+  game.reset_game();
+  game.setSeed(seed);
+  std::mt19937 pick(seed);
+  const size_t size = game.getDictionarySize();
+  for (size_t played = 0; played < used; ) {
+    uint32_t id = pick() % size;
+    if (game.is_used(std::string(game.getWord(id)))) continue;
+    game.applyMove(id, played % 2 == 0);
+    ++played;
+  }
+  if (used == 0) game.getRandomStartWord();
+}
+
+std::string json_escape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out;
+}
+
+bool write_json(const std::string& path, const std::string& dictionary, size_t words, uint32_t seed) {
+  std::ofstream out(path, std::ios::trunc);
+  out << "{\n  \"dictionary\": \"" << json_escape(dictionary) << "\",\n  \"words\": " << words
+      << ",\n  \"seed\": " << seed << ",\n  \"results\": [\n";
+  // One result per line, which is all --compare needs to read them back
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& r = results[i];
+    char numbers[160];
+    std::snprintf(numbers, sizeof(numbers),
+        "\"ops\": %llu, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, \"allocs_per_op\": %.3f",
+        static_cast<unsigned long long>(r.ops), r.ns_per_op, r.min_ns_per_op, r.allocs_per_op);
+    out << "    {\"name\": \"" << json_escape(r.name) << "\", \"fixture\": \"" << json_escape(r.fixture)
+        << "\", " << numbers << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+  return static_cast<bool>(out);
+}
+
+bool json_field(const std::string& line, const char* key, std::string& value) {
+  const std::string tag = std::string("\"") + key + "\": ";
+  size_t pos = line.find(tag);
+  if (pos == std::string::npos) return false;
+  pos += tag.length();
+  if (line[pos] == '"') {
+    size_t end = line.find('"', pos + 1);
+    value = line.substr(pos + 1, end - pos - 1);
+  } else {
+    size_t end = line.find_first_of(",}", pos);
+    value = line.substr(pos, end - pos);
+  }
+  return true;
+}
+
+// Compares min_ns_per_op against the baseline's; the fastest sample varies far
+// less from run to run than the median. Returns the number of regressions, -1 if the baseline can't be read.
+int compare_with(const std::string& path, double threshold_pct) {
+  std::ifstream in(path);
+  if (!in) return -1;
+  std::unordered_map<std::string, double> baseline;
+  std::string line, name, fixture, ns;
+  while (std::getline(in, line)) {
+    if (json_field(line, "name", name) && json_field(line, "fixture", fixture) &&
+        json_field(line, "min_ns_per_op", ns)) {
+      baseline[name + "/" + fixture] = std::strtod(ns.c_str(), nullptr);
+    }
+  }
+
+  int regressions = 0;
+  std::cout << "\n" << std::left << std::setw(42) << "benchmark" << std::setw(12) << "fixture" << std::right
+            << std::setw(14) << "base min" << std::setw(14) << "new min" << std::setw(10) << "change\n";
+  for (const BenchResult& r : results) {
+    std::cout << std::left << std::setw(42) << r.name << std::setw(12) << r.fixture << std::right;
+    auto it = baseline.find(r.name + "/" + r.fixture);
+    if (it == baseline.end() || it->second <= 0.0) {
+      std::cout << std::setw(14) << "-" << std::setw(14) << r.min_ns_per_op << "      new\n";
+      continue;
+    }
+    const double change = (r.min_ns_per_op / it->second - 1.0) * 100.0;
+    const bool regressed = change > threshold_pct;
+    regressions += regressed ? 1 : 0;
+    std::cout << std::setw(14) << it->second << std::setw(14) << r.min_ns_per_op << std::showpos << std::setw(9)
+              << change << "%" << std::noshowpos << (regressed ? "  REGRESSION" : "") << "\n";
+  }
+  return regressions;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const char* const usage =
+      "usage: bench <Dictionary dir> [--dictionary FILE] [--words N] [--seed N] [--samples N]"
+      " [--min-ms N] [--json FILE] [--compare FILE] [--threshold PCT]\n";
+  if (argc < 2) {
+    std::cerr << usage;
+    return 2;
+  }
+
+  const std::string data_dir = argv[1];
+  std::string dictionary;
+  size_t word_count = 120000;
+  uint32_t seed = 1;
+  std::string json_file;
+  std::string compare_file;
+  double threshold = 20.0;
+  for (int i = 2; i < argc; i += 2) {
+    const char* flag = argv[i];
+    if (i + 1 >= argc) {
+      std::cerr << "missing value for " << flag << "\n" << usage;
+      return 2;
+    }
+    const char* value = argv[i + 1];
+    if (!std::strcmp(flag, "--dictionary")) dictionary = value;
+    else if (!std::strcmp(flag, "--words")) word_count = std::strtoull(value, nullptr, 10);
+    else if (!std::strcmp(flag, "--seed")) seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    else if (!std::strcmp(flag, "--samples")) samples = std::max(1, std::atoi(value));
+    else if (!std::strcmp(flag, "--min-ms")) min_ms = std::max(1, std::atoi(value));
+    else if (!std::strcmp(flag, "--json")) json_file = value;
+    else if (!std::strcmp(flag, "--compare")) compare_file = value;
+    else if (!std::strcmp(flag, "--threshold")) threshold = std::strtod(value, nullptr);
+    else {
+      std::cerr << "unknown option " << flag << "\n" << usage;
+      return 2;
+    }
+  }
+
+  const std::string patterns = data_dir + "/rare_prefix.txt";
+  if (dictionary.empty()) {
+    dictionary = "bench_dictionary.txt";
+    if (!write_synthetic_dictionary(data_dir + "/solved_rare_prefix.txt", dictionary, word_count, seed)) {
+      std::cerr << "failed to generate " << dictionary << " from " << data_dir << "/solved_rare_prefix.txt\n";
+      return 1;
+    }
+  }
+
+  // load_database from the text file, then from the snapshot it leaves behind
+  measure("load_database", "text", [&](Stopwatch& watch) -> uint64_t {
+    std::remove((dictionary + ".snapshot").c_str());
+    ShiritoriGame game;
+    watch.start();
+    bool loaded = game.load_database(dictionary, patterns);
+    watch.stop();
+    sink = sink + loaded;
+    return 1;
+  }, 3, false);
+
+  ShiritoriGame game;
+  measure("load_database", "snapshot", [&](Stopwatch& watch) -> uint64_t {
+    watch.start();
+    bool loaded = game.load_database(dictionary, patterns);
+    watch.stop();
+    sink = sink + loaded;
+    return 1;
+  }, 3, false);
+  if (game.getDictionarySize() == 0) {
+    std::cerr << "failed to load " << dictionary << " / " << patterns << "\n";
+    return 1;
+  }
+
+  // Probes: dictionary words, misspellings of them, and 1-3 letter prefixes
+  std::mt19937 probe_rng(seed);
+  std::vector<std::string> words, lookups, prefixes;
+  for (int i = 0; i < 512; ++i) {
+    const std::string word(game.getWord(probe_rng() % game.getDictionarySize()));
+    words.push_back(word);
+    lookups.push_back(word);
+    lookups.push_back(word + "qx");
+    prefixes.push_back(word.substr(0, std::min<size_t>(word.length(), 1 + i % 3)));
+  }
+  // Rankings of one-letter prefixes take milliseconds, so fewer of those
+  const std::vector<std::string> ranking_prefixes(prefixes.begin(), prefixes.begin() + 64);
+
+  // The fast scoring must match the original map-based one bit for bit
+  std::vector<char> lexicon_chars;
+  std::vector<uint32_t> lexicon_offsets(1, 0);
+  for (uint32_t id = 0; id < game.getDictionarySize(); ++id) {
+    std::string_view word = game.getWord(id);
+    lexicon_chars.insert(lexicon_chars.end(), word.begin(), word.end());
+    lexicon_offsets.push_back(static_cast<uint32_t>(lexicon_chars.size()));
+  }
+  WordPool lexicon;
+  lexicon.adopt(std::move(lexicon_chars), std::move(lexicon_offsets));
+  std::vector<double> scores(lexicon.size());
+  calculateSolutionObscurityScores(lexicon, scores.data());
+  for (size_t i = 0; i < lexicon.size(); ++i) {
+    const double expected = calculateSolutionObscurityScoreReference(std::string(lexicon[i]));
+    if (std::memcmp(&scores[i], &expected, sizeof(double)) != 0) {
+      std::cerr << "obscurity mismatch for " << lexicon[i] << ": " << scores[i] << " != " << expected << "\n";
+      return 1;
+    }
+  }
+
+  // undoMove must put back everything applyMove changed: a random walk of
+  // moves and undos, each undo checked against the state before its move.
+  // Player moves are often one of the top solves, so they score points too.
+  {
+    prepare_fixture(game, 2000, seed);
+    std::vector<uint32_t> top_solves;
+    for (int turn = 0; turn < 40 && top_solves.empty(); ++turn) {
+      if (game.getAIMove().empty() || game.getCurrentPrefix().empty()) break;
+      for (const auto& move : game.getTopAIMoves(game.getCurrentPrefix())) {
+        top_solves.push_back(game.getWordId(move.word));
+      }
+      const auto regular = game.getRegularSolves(game.getCurrentPrefix(), 1);
+      if (top_solves.empty() && !regular.empty()) game.processPlayerWord(regular[0].word);
+    }
+    std::mt19937 walk(seed);
+    std::vector<std::pair<GameMove, uint64_t>> moves;
+    for (int step = 0; step < 600 || !moves.empty(); ++step) {
+      if (step < 600 && (moves.empty() || (moves.size() < 64 && walk() % 3 != 0))) {
+        const bool by_ai = walk() % 2 == 0;
+        uint32_t id = walk() % game.getDictionarySize();
+        if (!by_ai && !top_solves.empty() && walk() % 2 == 0) id = top_solves[walk() % top_solves.size()];
+        while (game.is_used(std::string(game.getWord(id)))) id = (id + 1) % game.getDictionarySize();
+        const uint64_t before = game.stateDigest();
+        moves.push_back({game.applyMove(id, by_ai), before});
+        continue;
+      }
+      game.undoMove(moves.back().first);
+      if (game.stateDigest() != moves.back().second) {
+        std::cerr << "undoMove of " << game.getWord(moves.back().first.word) << " did not restore the game\n";
+        return 1;
+      }
+      moves.pop_back();
+    }
+  }
+
+  // The posting cursors must stay on each slot's first unused word as words
+  // are used and freed in any mix, checked against a scan after every step
+  {
+    prepare_fixture(game, 0, seed);
+    std::mt19937 walk(seed + 1);
+    std::vector<GameMove> moves;
+    for (int step = 0; step < 300; ++step) {
+      if (moves.empty() || (moves.size() < 200 && walk() % 3 != 0)) {
+        // Mostly words sharing a prefix, so slots run dry and refill
+        uint32_t id = walk() % 64 == 0 ? walk() % game.getDictionarySize() : walk() % 400;
+        while (game.is_used(std::string(game.getWord(id)))) id = (id + 1) % game.getDictionarySize();
+        moves.push_back(game.applyMove(id, walk() % 2 == 0));
+      } else {
+        game.undoMove(moves.back());
+        moves.pop_back();
+      }
+      if (!game.postingCursorsMatchScan()) {
+        std::cerr << "posting cursors disagree with a scan after step " << step << "\n";
+        return 1;
+      }
+    }
+  }
+
+  measure("calculateSolutionObscurityScore", "none", [&](Stopwatch& watch) -> uint64_t {
+    double total = 0.0;
+    watch.start();
+    for (const auto& word : words) total += calculateSolutionObscurityScore(word);
+    watch.stop();
+    sink = sink + static_cast<size_t>(total);
+    return words.size();
+  });
+
+  measure("calculateSolutionObscurityScoreReference", "none", [&](Stopwatch& watch) -> uint64_t {
+    double total = 0.0;
+    watch.start();
+    for (const auto& word : words) total += calculateSolutionObscurityScoreReference(word);
+    watch.stop();
+    sink = sink + static_cast<size_t>(total);
+    return words.size();
+  });
+
+  // The single call over the batch's words, for a like-for-like comparison
+  std::vector<std::string> lexicon_words;
+  for (size_t i = 0; i < lexicon.size(); ++i) lexicon_words.emplace_back(lexicon[i]);
+  measure("calculateSolutionObscurityScore", "lexicon", [&](Stopwatch& watch) -> uint64_t {
+    double total = 0.0;
+    watch.start();
+    for (const auto& word : lexicon_words) total += calculateSolutionObscurityScore(word);
+    watch.stop();
+    sink = sink + static_cast<size_t>(total);
+    return lexicon_words.size();
+  });
+
+  measure("calculateSolutionObscurityScores", "lexicon", [&](Stopwatch& watch) -> uint64_t {
+    watch.start();
+    calculateSolutionObscurityScores(lexicon, scores.data());
+    watch.stop();
+    sink = sink + static_cast<size_t>(scores[0]);
+    return lexicon.size();
+  });
+
+  prepare_fixture(game, 0, seed);
+  measure("is_valid_word", "none", [&](Stopwatch& watch) -> uint64_t {
+    size_t valid = 0;
+    watch.start();
+    for (const auto& word : lookups) valid += game.is_valid_word(word);
+    watch.stop();
+    sink = sink + valid;
+    return lookups.size();
+  });
+
+  const size_t fixture_sizes[] = {0, 2000, 20000};
+  for (size_t used : fixture_sizes) {
+    const std::string fixture = "used_" + std::to_string(used);
+    prepare_fixture(game, used, seed);
+
+    measure("countSolutions", fixture, [&](Stopwatch& watch) -> uint64_t {
+      size_t total = 0;
+      watch.start();
+      for (const auto& prefix : prefixes) total += game.countSolutions(prefix);
+      watch.stop();
+      sink = sink + total;
+      return prefixes.size();
+    });
+
+    measure("getNewPrefix", fixture, [&](Stopwatch& watch) -> uint64_t {
+      size_t total = 0;
+      watch.start();
+      for (const auto& word : words) total += game.getNewPrefix(word, 4).length();
+      watch.stop();
+      sink = sink + total;
+      return words.size();
+    });
+
+    // The rankings fill one reused buffer, warmed up by an untimed pass
+    std::vector<WordRank> solves;
+    for (const auto& prefix : ranking_prefixes) game.getRegularSolves(prefix, 5, solves);
+    measure("getRegularSolves", fixture, [&](Stopwatch& watch) -> uint64_t {
+      size_t total = 0;
+      watch.start();
+      for (const auto& prefix : ranking_prefixes) total += game.getRegularSolves(prefix, 5, solves);
+      watch.stop();
+      sink = sink + total;
+      return ranking_prefixes.size();
+    });
+
+    // A move and its undo change the used-word epoch, so every call ranks afresh
+    uint32_t spare = 0;
+    while (game.is_used(std::string(game.getWord(spare)))) ++spare;
+    auto rank_afresh = [&](Stopwatch& watch) -> uint64_t {
+      size_t total = 0;
+      watch.start();
+      for (const auto& prefix : ranking_prefixes) {
+        GameMove move = game.applyMove(spare, false);
+        game.undoMove(move);
+        total += game.getTopAIMoves(prefix, TOP_MOVES_TO_SHOW, solves);
+      }
+      watch.stop();
+      sink = sink + total;
+      return ranking_prefixes.size();
+    };
+    Stopwatch warm_up;
+    rank_afresh(warm_up);
+    measure("getTopAIMoves", fixture, rank_afresh);
+
+    for (const auto& prefix : ranking_prefixes) game.getTopAIMoves(prefix, TOP_MOVES_TO_SHOW, solves);
+    measure("getTopAIMoves_cached", fixture, [&](Stopwatch& watch) -> uint64_t {
+      size_t total = 0;
+      watch.start();
+      for (const auto& prefix : ranking_prefixes) total += game.getTopAIMoves(prefix, TOP_MOVES_TO_SHOW, solves);
+      watch.stop();
+      sink = sink + total;
+      return ranking_prefixes.size();
+    });
+
+    // Up to 40 AI moves against the top-ranked reply, from the fixture each
+    // pass; the passes are identical, so one untimed pass warms up the game
+    auto play_turns = [&](Stopwatch& watch) -> uint64_t {
+      prepare_fixture(game, used, seed);
+      uint64_t moves = 0;
+      for (int turn = 0; turn < 40; ++turn) {
+        watch.start();
+        const std::string_view word = game.getAIMove();
+        watch.stop();
+        ++moves;
+        const std::string prefix = game.getCurrentPrefix();
+        if (word.empty() || prefix.empty()) break;
+        size_t replies = game.getTopAIMoves(prefix, 1, solves);
+        if (replies == 0) replies = game.getRegularSolves(prefix, 1, solves);
+        if (replies == 0) break;
+        game.processPlayerWord(solves[0].word);
+      }
+      return moves;
+    };
+    play_turns(warm_up);
+    measure("getAIMove", fixture, play_turns);
+  }
+
+  if (!json_file.empty() && !write_json(json_file, dictionary, game.getDictionarySize(), seed)) {
+    std::cerr << "failed to write " << json_file << "\n";
+    return 1;
+  }
+
+  int allocating = 0;
+  for (const BenchResult& r : results) {
+    const bool must_not_allocate = std::any_of(std::begin(ALLOCATION_FREE), std::end(ALLOCATION_FREE),
+        [&](const char* name) { return r.name == name; });
+    if (must_not_allocate && r.allocs_per_op > 0.0) {
+      std::cerr << r.name << "/" << r.fixture << " allocates " << r.allocs_per_op << " times per op\n";
+      ++allocating;
+    }
+  }
+
+  if (!compare_file.empty()) {
+    int regressions = compare_with(compare_file, threshold);
+    if (regressions < 0) {
+      std::cerr << "failed to read " << compare_file << "\n";
+      return 1;
+    }
+    std::cout << regressions << " regression(s) over " << threshold << "%\n";
+    if (regressions > 0) return 1;
+  }
+  return allocating > 0 ? 1 : 0;
+}
+
+// Counting replacements for the global allocation functions; the array and
+// sized forms forward to these
+void* operator new(size_t size) {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,136 @@
+// Throughput benchmark for the search and Monte Carlo engines. Plays the AI
+// against a greedy player (the top-ranked reply, else the first regular
+// solve) from a fixed seed and reports the cost of every engine move.
+//
+//   searchbench <dictionary> <patterns> [options]
+//     --engine search|mcts   engine under test (search)
+//     --moves N              engine moves to measure (40)
+//     --depth N              search: max depth (6)
+//     --budget-ms N          search: per-move budget (0 = depth only)
+//                            mcts: per-move budget at every difficulty
+//     --branch N             moves tried per node (engine default)
+//     --playouts N           mcts: fixed playouts per move instead of a budget
+//
+// Depth-limited searches and fixed playout counts are reproducible, so their
+// node and playout counts are comparable between builds.
+
+#include "shiritorigame.h"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "usage: searchbench <dictionary> <patterns> [--engine search|mcts] [--moves N]"
+                 " [--depth N] [--budget-ms N] [--branch N] [--playouts N]\n";
+    return 2;
+  }
+
+  bool monte_carlo = false;
+  int moves = 40;
+  int budget_ms = -1;
+  int branch = 0;
+  SearchConfig search;
+  search.time_budget_ms = 0;
+  MonteCarloConfig mcts;
+  for (int i = 3; i + 1 < argc; i += 2) {
+    const char* flag = argv[i];
+    const char* value = argv[i + 1];
+    if (!std::strcmp(flag, "--engine")) monte_carlo = !std::strcmp(value, "mcts");
+    else if (!std::strcmp(flag, "--moves")) moves = std::atoi(value);
+    else if (!std::strcmp(flag, "--depth")) search.max_depth = std::atoi(value);
+    else if (!std::strcmp(flag, "--budget-ms")) budget_ms = std::atoi(value);
+    else if (!std::strcmp(flag, "--branch")) branch = std::atoi(value);
+    else if (!std::strcmp(flag, "--playouts")) mcts.max_playouts = std::strtoull(value, nullptr, 10);
+    else {
+      std::cerr << "unknown option " << flag << "\n";
+      return 2;
+    }
+  }
+  if (budget_ms >= 0) {
+    search.time_budget_ms = budget_ms;
+    for (int& budget : mcts.budget_ms) budget = budget_ms;
+  }
+  if (branch > 0) {
+    search.branch_limit = branch;
+    mcts.branch_limit = branch;
+  }
+
+  ShiritoriGame game;
+  if (!game.load_database(argv[1], argv[2])) {
+    std::cerr << "failed to load " << argv[1] << " / " << argv[2] << "\n";
+    return 1;
+  }
+  game.setSeed(1);
+  game.setAIEngine(monte_carlo ? AIEngine::MonteCarlo : AIEngine::Search);
+  game.setSearchConfig(search);
+  game.setMonteCarloConfig(mcts);
+
+  // Nodes for the search engine, playouts for Monte Carlo
+  uint64_t total_work = 0;
+  uint64_t total_extra = 0;
+  long long total_ms = 0;
+  long long depth_sum = 0;
+  int measured = 0;
+  const char* unit = monte_carlo ? "playouts" : "nodes";
+
+  std::cout << std::fixed << std::setprecision(0);
+  game.reset_game();
+  game.getRandomStartWord();
+  while (measured < moves) {
+    const std::string_view ai_word = game.getAIMove();
+    const SearchStats& search_stats = game.getLastSearchStats();
+    const MonteCarloStats& mcts_stats = game.getLastMonteCarloStats();
+    const std::string& engine_word = monte_carlo ? mcts_stats.best_word : search_stats.best_word;
+    if (!ai_word.empty() && engine_word == ai_word) {
+      ++measured;
+      const uint64_t work = monte_carlo ? mcts_stats.playouts : search_stats.nodes;
+      const long long ms = monte_carlo ? mcts_stats.elapsed_ms : search_stats.elapsed_ms;
+      const int depth = monte_carlo ? mcts_stats.tree_depth : search_stats.depth_reached;
+      total_work += work;
+      total_extra += monte_carlo ? mcts_stats.tree_nodes : search_stats.table_hits;
+      total_ms += ms;
+      depth_sum += depth;
+
+      std::cout << std::setw(4) << measured << "  " << std::setw(18) << std::left << ai_word << std::right
+                << " depth " << std::setw(2) << depth << "  " << unit << " " << std::setw(9) << work;
+      if (monte_carlo) {
+        std::cout << "  tree " << std::setw(8) << mcts_stats.tree_nodes << "  win "
+                  << std::setprecision(2) << mcts_stats.best_win_rate << std::setprecision(0);
+      } else {
+        std::cout << "  hits " << std::setw(8) << search_stats.table_hits;
+      }
+      std::cout << "  " << std::setw(6) << ms << " ms  " << std::setw(9)
+                << (monte_carlo ? mcts_stats.playouts_per_second : search_stats.nodes_per_second)
+                << " " << unit << "/s\n";
+    }
+
+    // Start over whenever either side runs out of words
+    const std::string prefix = game.getCurrentPrefix();
+    std::string reply;
+    if (!ai_word.empty() && !prefix.empty()) {
+      auto top = game.getTopAIMoves(prefix, 1);
+      if (!top.empty()) {
+        reply = top[0].word;
+      } else {
+        auto regular = game.getRegularSolves(prefix, 1);
+        if (!regular.empty()) reply = regular[0].word;
+      }
+    }
+    if (reply.empty()) {
+      game.reset_game();
+      game.getRandomStartWord();
+      continue;
+    }
+    game.processPlayerWord(reply);
+  }
+
+  const double seconds = total_ms / 1000.0;
+  std::cout << std::setprecision(2)
+            << "\nmoves " << measured << "  avg depth " << (measured ? double(depth_sum) / measured : 0.0)
+            << "  " << unit << " " << total_work << "  " << (monte_carlo ? "tree nodes " : "table hits ")
+            << total_extra << "  time " << seconds << " s  " << std::setprecision(0)
+            << (seconds > 0.0 ? total_work / seconds : 0.0) << " " << unit << "/s\n";
+  return 0;
+}
@@ -0,0 +1,24 @@
+# Console benchmark for the search and Monte Carlo engines; builds without Qt
+TEMPLATE = app
+TARGET = searchbench
+CONFIG += console c++17 release thread
+CONFIG -= app_bundle qt
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../lexiconsnapshot.cpp \
+    ../../shiritorigame.cpp \
+    ../../shiritorimcts.cpp \
+    ../../shiritorisearch.cpp \
+    ../../tracing.cpp \
+    ../../workstealingpool.cpp
+
+HEADERS += \
+    ../../lexiconsnapshot.h \
+    ../../scratcharena.h \
+    ../../shiritorigame.h \
+    ../../tracing.h \
+    ../../turnprofile.h \
+    ../../workstealingpool.h
@@ -0,0 +1,245 @@
+// Headless self-play load test. Plays getAIMove against a scripted player
+// (the top-ranked solve, else the first regular solve) or against getAIMove
+// itself, from a fixed seed, and reports throughput and per-move latency.
+//
+//   selfplay <dictionary> <patterns> [options]
+//     --games N              games to play (100)
+//     --seed N               rng seed (1)
+//     --player top|ai        player side: scripted top solve, or getAIMove (top)
+//     --max-turns N          turn cap per game (1000)
+//     --engine heuristic|search|mcts
+//     --threads N            lookahead threads (0 = every hardware thread)
+//     --stress               one game of getAIMove on both sides until every
+//                            word is used, reporting latency per window
+//     --window N             stress: turns per report line (500)
+//     --trace FILE           write a Chrome trace of the run to FILE
+//
+// Latency is measured around getAIMove only; scripted player moves are not timed.
+// Each game is tallied by how it ended: the AI gave up (no restart word), the
+// player was stuck, or the game reached --max-turns.
+// "rare" is the share of AI moves that leave the other side one of the patterns
+// file's rare prefixes.
+
+#include "shiritorigame.h"
+#include "tracing.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_us(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// Nearest-rank percentile of an unsorted sample, in the sample's unit
+double percentile(std::vector<double> samples, double p) {
+  if (samples.empty()) return 0.0;
+  size_t rank = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+  std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+  return samples[rank];
+}
+
+void print_latency(const std::vector<double>& us) {
+  double total = 0.0;
+  for (double sample : us) total += sample;
+  std::cout << std::setprecision(3)
+            << "mean " << (us.empty() ? 0.0 : total / us.size() / 1000.0) << " ms  p50 "
+            << percentile(us, 0.50) / 1000.0 << " ms  p99 " << percentile(us, 0.99) / 1000.0
+            << " ms  max " << (us.empty() ? 0.0 : *std::max_element(us.begin(), us.end()) / 1000.0) << " ms";
+}
+
+// The scripted player's answer to the current prefix, "" when it has none
+std::string scripted_reply(ShiritoriGame& game) {
+  const std::string prefix = game.getCurrentPrefix();
+  if (prefix.empty()) return "";
+  auto top = game.getTopAIMoves(prefix, 1);
+  if (!top.empty()) return top[0].word;
+  auto regular = game.getRegularSolves(prefix, 1);
+  return regular.empty() ? "" : regular[0].word;
+}
+
+void write_trace(const std::string& path) {
+  if (path.empty()) return;
+  trace_stop();
+  if (!trace_write_chrome_json(path)) std::cerr << "failed to write trace " << path << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "usage: selfplay <dictionary> <patterns> [--games N] [--seed N] [--player top|ai]"
+                 " [--max-turns N] [--engine heuristic|search|mcts] [--threads N] [--stress] [--window N] [--trace FILE]\n";
+    return 2;
+  }
+
+  int games = 100;
+  uint32_t seed = 1;
+  bool ai_player = false;
+  int max_turns = 1000;
+  AIEngine engine = AIEngine::Heuristic;
+  int threads = -1;
+  bool stress = false;
+  int window = 500;
+  std::string trace_path;
+  for (int i = 3; i < argc; ++i) {
+    const char* flag = argv[i];
+    if (!std::strcmp(flag, "--stress")) {
+      stress = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "missing value for " << flag << "\n";
+      return 2;
+    }
+    const char* value = argv[++i];
+    if (!std::strcmp(flag, "--games")) games = std::atoi(value);
+    else if (!std::strcmp(flag, "--seed")) seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    else if (!std::strcmp(flag, "--player")) ai_player = !std::strcmp(value, "ai");
+    else if (!std::strcmp(flag, "--max-turns")) max_turns = std::atoi(value);
+    else if (!std::strcmp(flag, "--engine")) {
+      engine = !std::strcmp(value, "search") ? AIEngine::Search
+             : !std::strcmp(value, "mcts") ? AIEngine::MonteCarlo : AIEngine::Heuristic;
+    }
+    else if (!std::strcmp(flag, "--threads")) threads = std::atoi(value);
+    else if (!std::strcmp(flag, "--window")) window = std::max(1, std::atoi(value));
+    else if (!std::strcmp(flag, "--trace")) trace_path = value;
+    else {
+      std::cerr << "unknown option " << flag << "\n";
+      return 2;
+    }
+  }
+
+  if (!trace_path.empty()) {
+    trace_set_thread_name("main");
+    trace_start();
+  }
+
+  ShiritoriGame game;
+  if (!game.load_database(argv[1], argv[2])) {
+    std::cerr << "failed to load " << argv[1] << " / " << argv[2] << "\n";
+    return 1;
+  }
+  game.setSeed(seed);
+  game.setAIEngine(engine);
+  if (threads >= 0) game.setWorkerThreads(static_cast<unsigned>(threads));
+
+  std::vector<double> latency_us;
+  std::cout << std::fixed;
+
+  if (stress) {
+    // Both sides use getAIMove, which restarts the chain whenever a prefix
+    // runs dry. Its restart only samples the first 1000 words, so once that
+    // fails the tool restarts from the next unused word itself, and the game
+    // ends when the dictionary is used up. Every turn uses up one word.
+    std::vector<double> window_us;
+    const auto start = Clock::now();
+    game.reset_game();
+    game.getRandomStartWord();
+    int turns = 1;
+    int restarts = 0;
+    uint32_t next_unused = 0;
+    for (;;) {
+      const auto move_start = Clock::now();
+      const std::string_view word = game.getAIMove();
+      const double us = elapsed_us(move_start);
+      if (word.empty()) {
+        while (next_unused < game.getDictionarySize() &&
+               game.is_used(std::string(game.getWord(next_unused)))) {
+          ++next_unused;
+        }
+        if (next_unused == game.getDictionarySize()) break;
+        game.applyMove(next_unused, true);
+        ++restarts;
+        ++turns;
+        continue;
+      }
+      ++turns;
+      latency_us.push_back(us);
+      window_us.push_back(us);
+      if (static_cast<int>(window_us.size()) == window) {
+        std::cout << "words used " << std::setw(6) << turns << "  ";
+        print_latency(window_us);
+        std::cout << "\n";
+        window_us.clear();
+      }
+    }
+    if (!window_us.empty()) {
+      std::cout << "words used " << std::setw(6) << turns << "  ";
+      print_latency(window_us);
+      std::cout << "\n";
+    }
+
+    const double seconds = elapsed_us(start) / 1e6;
+    std::cout << std::setprecision(2) << "\nturns " << turns << "  tool restarts " << restarts
+              << "  time " << seconds << " s  "
+              << std::setprecision(0) << (seconds > 0.0 ? turns / seconds : 0.0) << " turns/s\n";
+    print_latency(latency_us);
+    std::cout << "\n";
+    write_trace(trace_path);
+    return 0;
+  }
+
+  long long total_turns = 0;
+  long long rare_moves = 0;
+  // How games end: getAIMove returning "" on the AI's turn means its random
+  // restart found no start word, so the AI gave up; the player is stuck when
+  // it has no reply; otherwise the game ran into --max-turns
+  int ai_gave_up = 0;
+  int player_stuck = 0;
+  const auto start = Clock::now();
+  for (int g = 0; g < games; ++g) {
+    game.reset_game();
+    game.getRandomStartWord();
+    int turns = 1;
+    bool ai_to_move = true;
+    while (turns < max_turns) {
+      std::string word;
+      if (ai_to_move || ai_player) {
+        // An AI player loses where the AI would restart the chain
+        if (!ai_to_move && game.getCurrentPrefix().empty()) {
+          ++player_stuck;
+          break;
+        }
+        const auto move_start = Clock::now();
+        word = game.getAIMove();
+        latency_us.push_back(elapsed_us(move_start));
+        if (word.empty()) {
+          ++(ai_to_move ? ai_gave_up : player_stuck);
+          break;
+        }
+        if (game.isRarePrefix(game.getCurrentPrefix())) ++rare_moves;
+      } else {
+        word = scripted_reply(game);
+        if (word.empty()) {
+          ++player_stuck;
+          break;
+        }
+        game.processPlayerWord(word);
+      }
+      ++turns;
+      ai_to_move = !ai_to_move;
+    }
+    total_turns += turns;
+  }
+
+  const double seconds = elapsed_us(start) / 1e6;
+  std::cout << std::setprecision(2)
+            << "games " << games << "  turns " << total_turns << "  time " << seconds << " s\n"
+            << "AI gave up " << ai_gave_up << "  player stuck " << player_stuck
+            << "  turn cap " << (games - ai_gave_up - player_stuck) << "\n"
+            << "games/s " << (seconds > 0.0 ? games / seconds : 0.0)
+            << "  turns/s " << (seconds > 0.0 ? total_turns / seconds : 0.0)
+            << "  AI moves " << latency_us.size() << "  rare "
+            << (latency_us.empty() ? 0.0 : 100.0 * rare_moves / latency_us.size()) << "%\n";
+  print_latency(latency_us);
+  std::cout << "\n";
+  write_trace(trace_path);
+  return 0;
+}
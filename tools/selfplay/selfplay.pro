@@ -0,0 +1,24 @@
+# Headless AI self-play load test; builds without Qt
+TEMPLATE = app
+TARGET = selfplay
+CONFIG += console c++17 release thread
+CONFIG -= app_bundle qt
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../lexiconsnapshot.cpp \
+    ../../shiritorigame.cpp \
+    ../../shiritorimcts.cpp \
+    ../../shiritorisearch.cpp \
+    ../../tracing.cpp \
+    ../../workstealingpool.cpp
+
+HEADERS += \
+    ../../lexiconsnapshot.h \
+    ../../scratcharena.h \
+    ../../shiritorigame.h \
+    ../../tracing.h \
+    ../../turnprofile.h \
+    ../../workstealingpool.h
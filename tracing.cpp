@@ -0,0 +1,130 @@
+#include "tracing.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> g_trace_enabled(false);
+
+namespace {
+
+const size_t TRACE_BUFFER_SPANS = 1 << 16;
+
+struct TraceEvent {
+  const char* name;
+  int64_t start_ns;
+  int64_t end_ns;
+};
+
+// Appended to by its own thread only. `count` is published with release
+// ordering, so a concurrent dump never reads a half-written span.
+struct ThreadTraceBuffer {
+  std::unique_ptr<TraceEvent[]> spans{new TraceEvent[TRACE_BUFFER_SPANS]};
+  std::atomic<size_t> count{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<uint64_t> generation{0};  // trace_start call the spans belong to
+  uint32_t tid = 0;
+  std::string thread_name;              // guarded by registry_mutex
+};
+
+std::mutex registry_mutex;
+// Buffers outlive their threads, so spans of finished threads are kept
+std::vector<std::unique_ptr<ThreadTraceBuffer>> registry;
+std::atomic<uint64_t> trace_generation(0);
+const std::chrono::steady_clock::time_point trace_epoch = std::chrono::steady_clock::now();
+
+ThreadTraceBuffer& thread_buffer() {
+  thread_local ThreadTraceBuffer* buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.emplace_back(new ThreadTraceBuffer());
+    buffer = registry.back().get();
+    buffer->tid = static_cast<uint32_t>(registry.size());
+  }
+  return *buffer;
+}
+
+std::string json_escape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20) out += c;
+  }
+  return out;
+}
+
+} // namespace
+
+void trace_start() {
+  trace_generation.fetch_add(1);
+  g_trace_enabled.store(true);
+}
+
+void trace_stop() {
+  g_trace_enabled.store(false);
+}
+
+void trace_set_thread_name(const char* name) {
+  ThreadTraceBuffer& buffer = thread_buffer();
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  buffer.thread_name = name;
+}
+
+int64_t trace_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - trace_epoch).count();
+}
+
+void trace_record(const char* name, int64_t start_ns, int64_t end_ns) {
+  ThreadTraceBuffer& buffer = thread_buffer();
+  // The first span after a trace_start discards this thread's older ones
+  const uint64_t generation = trace_generation.load(std::memory_order_acquire);
+  if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+    buffer.count.store(0, std::memory_order_relaxed);
+    buffer.dropped.store(0, std::memory_order_relaxed);
+    buffer.generation.store(generation, std::memory_order_release);
+  }
+
+  const size_t n = buffer.count.load(std::memory_order_relaxed);
+  if (n >= TRACE_BUFFER_SPANS) {
+    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer.spans[n] = {name, start_ns, end_ns};
+  buffer.count.store(n + 1, std::memory_order_release);
+}
+
+bool trace_write_chrome_json(const std::string& path) {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) return false;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  const uint64_t generation = trace_generation.load(std::memory_order_acquire);
+  uint64_t dropped = 0;
+  bool first = true;
+  char line[256];
+
+  out << "{\"traceEvents\":[\n";
+  for (const auto& buffer : registry) {
+    if (buffer->generation.load(std::memory_order_acquire) != generation) continue;
+    const size_t count = buffer->count.load(std::memory_order_acquire);
+    dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+    if (!buffer->thread_name.empty()) {
+      out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+          << ",\"args\":{\"name\":\"" << json_escape(buffer->thread_name) << "\"}}";
+      first = false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      const TraceEvent& span = buffer->spans[i];
+      // Chrome wants microseconds
+      std::snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+          span.name, buffer->tid, span.start_ns / 1000.0, (span.end_ns - span.start_ns) / 1000.0);
+      out << (first ? "" : ",\n") << line;
+      first = false;
+    }
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_spans\":" << dropped << "}}\n";
+  return static_cast<bool>(out);
+}
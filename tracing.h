@@ -0,0 +1,52 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Opt-in span tracing written as Chrome trace-event JSON (chrome://tracing,
+// ui.perfetto.dev). Every thread appends to its own fixed-size buffer with no
+// locking; a full buffer drops further spans. While tracing is off a span
+// costs one relaxed atomic load.
+
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool trace_enabled() {
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+// Clears any recorded spans and starts recording
+void trace_start();
+void trace_stop();
+// Labels the calling thread in the trace
+void trace_set_thread_name(const char* name);
+// Writes every span recorded since trace_start; best called after trace_stop
+bool trace_write_chrome_json(const std::string& path);
+
+int64_t trace_now_ns();
+void trace_record(const char* name, int64_t start_ns, int64_t end_ns);
+
+// Records the enclosing scope under `name`, which must be a string literal
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : m_name(trace_enabled() ? name : nullptr), m_start(m_name ? trace_now_ns() : 0) {}
+    ~TraceSpan() {
+        if (m_name) trace_record(m_name, m_start, trace_now_ns());
+    }
+
+private:
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    const char* m_name;
+    int64_t m_start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(name)
+
+#endif // TRACING_H
@@ -0,0 +1,75 @@
+#ifndef TURNPROFILE_H
+#define TURNPROFILE_H
+
+#include <chrono>
+#include <cstdint>
+
+// Build with SHIRITORI_PROFILING defined to time the phases of a turn; without
+// it the TURN_PROFILE_* macros expand to nothing and every profile stays zero.
+#ifdef SHIRITORI_PROFILING
+const bool TURN_PROFILING_ENABLED = true;
+#else
+const bool TURN_PROFILING_ENABLED = false;
+#endif
+
+enum TurnPhase {
+    PHASE_COLLECT,          // getAIMove: gather the unused candidates
+    PHASE_SCORE,            // getAIMove: score_candidate over them
+    PHASE_SORT,             // getAIMove: order them by score
+    PHASE_LOOKAHEAD,        // getAIMove: check the best ones leave a reply
+    PHASE_TOP_SOLVES,       // getTopAIMoves
+    PHASE_REGULAR_SOLVES,   // getRegularSolves
+    PHASE_COUNT
+};
+
+inline const char* turn_phase_name(int phase) {
+    static const char* const names[PHASE_COUNT] = {
+        "collect", "score", "sort", "lookahead", "topSolves", "regularSolves"
+    };
+    return names[phase];
+}
+
+// Gathered on the thread running the turn; the parallel lookahead is timed as
+// a whole but its own scans are not counted
+struct TurnProfile {
+    int64_t phase_ns[PHASE_COUNT] = {};
+    uint64_t candidates = 0;        // words scored or ranked
+    uint64_t entries_scanned = 0;   // dictionary entries visited
+    uint64_t used_probes = 0;       // used-bit and unused-count lookups
+};
+
+#ifdef SHIRITORI_PROFILING
+
+class TurnPhaseTimer {
+public:
+    TurnPhaseTimer(TurnProfile& profile, TurnPhase phase)
+        : m_profile(profile), m_phase(phase), m_start(std::chrono::steady_clock::now()) {}
+    ~TurnPhaseTimer() {
+        m_profile.phase_ns[m_phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    TurnPhaseTimer(const TurnPhaseTimer&) = delete;
+    TurnPhaseTimer& operator=(const TurnPhaseTimer&) = delete;
+
+    TurnProfile& m_profile;
+    TurnPhase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define TURN_PROFILE_CONCAT_(a, b) a##b
+#define TURN_PROFILE_CONCAT(a, b) TURN_PROFILE_CONCAT_(a, b)
+// Times the rest of the enclosing scope
+#define TURN_PROFILE_SCOPE(profile, phase) \
+    TurnPhaseTimer TURN_PROFILE_CONCAT(turn_phase_timer_, __LINE__)((profile), (phase))
+#define TURN_PROFILE_COUNT(profile, counter, n) ((profile).counter += (n))
+
+#else
+
+#define TURN_PROFILE_SCOPE(profile, phase) ((void)0)
+#define TURN_PROFILE_COUNT(profile, counter, n) ((void)0)
+
+#endif // SHIRITORI_PROFILING
+
+#endif // TURNPROFILE_H
@@ -0,0 +1,94 @@
+#include "workstealingpool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < threads; ++i) m_queues.emplace_back(new Queue());
+  // Queue 0 belongs to whichever thread calls parallel_for
+  for (unsigned i = 1; i < threads; ++i) m_workers.emplace_back(&WorkStealingPool::worker_loop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (auto& worker : m_workers) worker.join();
+}
+
+void WorkStealingPool::parallel_for(size_t count, const std::function<void(size_t)>& task) {
+  if (count == 0) return;
+  if (m_queues.size() == 1 || count == 1) {
+    for (size_t i = 0; i < count; ++i) task(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> job(m_jobMutex);
+  m_task = &task;
+  m_remaining.store(count);
+
+  const size_t threads = m_queues.size();
+  for (size_t q = 0; q < threads; ++q) {
+    std::lock_guard<std::mutex> lock(m_queues[q]->mutex);
+    m_queues[q]->begin = q * count / threads;
+    m_queues[q]->end = (q + 1) * count / threads;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    ++m_generation;
+  }
+  m_wake.notify_all();
+
+  run_tasks(0);
+
+  std::unique_lock<std::mutex> lock(m_stateMutex);
+  m_done.wait(lock, [this] { return m_remaining.load() == 0; });
+  m_task = nullptr;
+}
+
+bool WorkStealingPool::pop_local(unsigned self, size_t& index) {
+  Queue& queue = *m_queues[self];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.begin == queue.end) return false;
+  index = queue.begin++;
+  return true;
+}
+
+// Victims are visited in a fixed rotation starting after `self`
+bool WorkStealingPool::steal(unsigned self, size_t& index) {
+  const unsigned threads = size();
+  for (unsigned offset = 1; offset < threads; ++offset) {
+    Queue& victim = *m_queues[(self + offset) % threads];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.begin == victim.end) continue;
+    index = --victim.end;
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingPool::run_tasks(unsigned self) {
+  size_t index;
+  while (pop_local(self, index) || steal(self, index)) {
+    (*m_task)(index);
+    if (m_remaining.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lock(m_stateMutex);
+      m_done.notify_all();
+    }
+  }
+}
+
+void WorkStealingPool::worker_loop(unsigned self) {
+  unsigned long long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(m_stateMutex);
+      m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+      if (m_stop) return;
+      seen = m_generation;
+    }
+    run_tasks(self);
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads running one parallel_for at a time. Each thread starts
+// on its own contiguous block of indices and, once that runs dry, steals from
+// the far end of another thread's block, so uneven tasks still balance out.
+class WorkStealingPool {
+public:
+    // 0 threads means one per hardware thread; the calling thread counts as one
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    unsigned size() const { return static_cast<unsigned>(m_queues.size()); }
+
+    // Runs task(i) for every i in [0, count) and returns once all have run.
+    // Tasks may run in any order and on any thread; callers that need a
+    // deterministic result write to slot i and combine afterwards.
+    void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // The indices still to run in a thread's block: the owner takes them
+    // from the front, thieves from the back
+    struct Queue {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    bool pop_local(unsigned self, size_t& index);
+    bool steal(unsigned self, size_t& index);
+    void run_tasks(unsigned self);
+    void worker_loop(unsigned self);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::mutex m_jobMutex;              // serialises parallel_for callers
+
+    std::mutex m_stateMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(size_t)>* m_task = nullptr;
+    std::atomic<size_t> m_remaining{0};
+    unsigned long long m_generation = 0;
+    bool m_stop = false;
+};
+
+#endif // WORKSTEALINGPOOL_H